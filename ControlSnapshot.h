@@ -0,0 +1,432 @@
+/* Control Set Snapshots
+A binary file holding a whole control set (ID, type and state of every
+control) that is memory-mapped and read in place: opening one checks the
+header and the string table, and nothing is parsed or allocated per control.
+
+File layout (native byte order; every position is an offset from the start of
+the file, so a snapshot can be mapped at any address or copied as is):
+    FileHeader           magic, format version, counts and section offsets
+    Record[count]        id, type code, state code (8 bytes each)
+    StringEntry[strings] offset and length of each interned string
+    chars                the interned type and state strings, back to back
+
+Type and state strings are interned: each distinct one is stored once and
+records refer to it by a 16-bit code, so filters can compare codes.
+
+Writing is incremental. A Writer streams records into a temporary file next
+to the snapshot as they are added, and finish() writes the string table and
+a completed header and renames it over the snapshot; reopening a finished
+snapshot with Writer::Append adds records after the existing ones. Until
+then the previous snapshot, if any, is left untouched, and a writer that is
+destroyed by an exception discards its records instead of finishing.
+
+Usage:
+    snapshot::Writer writer("controls.snap");
+    writer.add(controls.begin(), controls.end());
+    writer.finish();
+
+    snapshot::Snapshot controls("controls.snap");
+    uint16_t slider;
+    if (controls.find("slider", slider) && controls[0].type == slider) ...
+*/
+
+#ifndef CONTROL_SNAPSHOT_H
+#define CONTROL_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HMI_HAS_MMAP 1
+#endif
+
+namespace snapshot {
+
+const char MAGIC[8] = {'H', 'M', 'I', 'S', 'N', 'A', 'P', '\0'};
+const uint32_t FORMAT_VERSION = 1;      // bump on any layout change
+const uint32_t BYTE_ORDER_MARK = 0x01020304; // reads back differently on the other endianness
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t headerBytes;    // sizeof(FileHeader) of the writer
+    uint32_t complete;       // 0 while a writer is still adding records
+    uint64_t recordCount;
+    uint64_t recordsOffset;
+    uint64_t stringsOffset;  // StringEntry table
+    uint64_t stringCount;
+    uint64_t charsOffset;
+    uint64_t fileBytes;
+};
+
+struct Record {
+    int32_t id;
+    uint16_t type;   // string code
+    uint16_t state;  // string code
+};
+
+struct StringEntry {
+    uint32_t offset; // from FileHeader::charsOffset
+    uint32_t length;
+};
+
+static_assert(std::is_trivially_copyable<FileHeader>::value && sizeof(FileHeader) == 72, "FileHeader layout");
+static_assert(std::is_trivially_copyable<Record>::value && sizeof(Record) == 8, "Record layout");
+static_assert(sizeof(StringEntry) == 8, "StringEntry layout");
+
+// A finished snapshot file, mapped read-only. Codes in the records are
+// checked when they are turned into strings, not when the file is opened.
+class Snapshot {
+public:
+    explicit Snapshot(const std::string& path) {
+        map(path);
+        try {
+            validate(path);
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    ~Snapshot() { unmap(); }
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    const FileHeader& fileHeader() const { return *header; }
+    uint32_t version() const { return header->version; }
+    size_t size() const { return static_cast<size_t>(header->recordCount); }
+    size_t stringCount() const { return static_cast<size_t>(header->stringCount); }
+    size_t fileBytes() const { return bytes; }
+
+    const Record& operator[](size_t i) const { return records[i]; }
+    const Record* begin() const { return records; }
+    const Record* end() const { return records + size(); }
+
+    std::string_view string(uint16_t code) const {
+        if (code >= header->stringCount) {
+            throw std::runtime_error("snapshot string code out of range");
+        }
+        return std::string_view(chars + strings[code].offset, strings[code].length);
+    }
+
+    std::string_view type(size_t i) const { return string(records[i].type); }
+    std::string_view state(size_t i) const { return string(records[i].state); }
+
+    // Code of an interned string; false if no control uses it
+    bool find(std::string_view text, uint16_t& code) const {
+        for (size_t i = 0; i < header->stringCount; i++) {
+            if (string(static_cast<uint16_t>(i)) == text) {
+                code = static_cast<uint16_t>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Copies into owning controls ({id, type, state} aggregates), for code
+    // that needs to modify them
+    template <typename C>
+    std::vector<C> toVector() const {
+        std::vector<C> result;
+        result.reserve(size());
+        for (size_t i = 0; i < size(); i++) {
+            result.push_back(C{records[i].id, std::string(type(i)), std::string(state(i))});
+        }
+        return result;
+    }
+
+private:
+    const char* base = nullptr;
+    size_t bytes = 0;
+#ifdef HMI_HAS_MMAP
+    void* mapping = nullptr;
+#endif
+    std::unique_ptr<uint64_t[]> buffer; // file contents where mmap is unavailable
+    const FileHeader* header = nullptr;
+    const Record* records = nullptr;
+    const StringEntry* strings = nullptr;
+    const char* chars = nullptr;
+
+    void map(const std::string& path) {
+#ifdef HMI_HAS_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open snapshot " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+            close(fd);
+            throw std::runtime_error("snapshot too small: " + path);
+        }
+        bytes = static_cast<size_t>(info.st_size);
+        mapping = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            throw std::runtime_error("cannot map snapshot " + path);
+        }
+        base = static_cast<const char*>(mapping);
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            throw std::runtime_error("cannot open snapshot " + path);
+        }
+        bytes = static_cast<size_t>(in.tellg());
+        if (bytes < sizeof(FileHeader)) {
+            throw std::runtime_error("snapshot too small: " + path);
+        }
+        buffer.reset(new uint64_t[(bytes + 7) / 8]);
+        in.seekg(0);
+        if (!in.read(reinterpret_cast<char*>(buffer.get()), static_cast<std::streamsize>(bytes))) {
+            throw std::runtime_error("cannot read snapshot " + path);
+        }
+        base = reinterpret_cast<const char*>(buffer.get());
+#endif
+    }
+
+    void unmap() {
+#ifdef HMI_HAS_MMAP
+        if (mapping != nullptr) {
+            munmap(mapping, bytes);
+            mapping = nullptr;
+        }
+#endif
+    }
+
+    void validate(const std::string& path) {
+        header = reinterpret_cast<const FileHeader*>(base);
+        auto fail = [&path](const char* reason) { throw std::runtime_error(std::string(reason) + ": " + path); };
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) fail("not a control snapshot");
+        if (header->byteOrder != BYTE_ORDER_MARK) fail("snapshot has the wrong byte order");
+        if (header->version != FORMAT_VERSION) fail("unsupported snapshot version");
+        if (header->headerBytes < sizeof(FileHeader)) fail("snapshot header too small");
+        if (header->complete != 1) fail("snapshot was not finished");
+        if (header->fileBytes != bytes) fail("snapshot size does not match its header");
+
+        uint64_t recordBytes = header->recordCount * sizeof(Record);
+        bool layoutOk = header->recordsOffset >= header->headerBytes && header->recordsOffset % alignof(Record) == 0 &&
+                        header->recordCount <= bytes / sizeof(Record) &&
+                        header->stringsOffset >= header->recordsOffset &&
+                        header->stringsOffset - header->recordsOffset >= recordBytes &&
+                        header->stringsOffset % alignof(StringEntry) == 0 && header->stringCount <= UINT16_MAX + 1ull &&
+                        header->charsOffset >= header->stringsOffset &&
+                        header->charsOffset - header->stringsOffset >= header->stringCount * sizeof(StringEntry) &&
+                        header->charsOffset <= bytes;
+        if (!layoutOk) fail("snapshot sections are out of bounds");
+
+        records = reinterpret_cast<const Record*>(base + header->recordsOffset);
+        strings = reinterpret_cast<const StringEntry*>(base + header->stringsOffset);
+        chars = base + header->charsOffset;
+        uint64_t charBytes = bytes - header->charsOffset;
+        for (uint64_t i = 0; i < header->stringCount; i++) {
+            if (strings[i].offset > charBytes || strings[i].length > charBytes - strings[i].offset) {
+                fail("snapshot string table is out of bounds");
+            }
+        }
+    }
+};
+
+// Streams records into a snapshot file. The file is only replaced by
+// finish(), which the destructor calls if it has not been called, unless the
+// writer is being destroyed while an exception propagates.
+class Writer {
+public:
+    enum Mode { Create, Append };
+
+    explicit Writer(const std::string& path, Mode mode = Create)
+        : path(path), partPath(path + ".partial"), exceptionsAtStart(std::uncaught_exceptions()) {
+        if (mode == Append) {
+            uint64_t recordsEnd;
+            {
+                Snapshot existing(path);
+                for (size_t i = 0; i < existing.stringCount(); i++) {
+                    intern(existing.string(static_cast<uint16_t>(i)));
+                }
+                if (existing.fileHeader().recordsOffset != sizeof(FileHeader)) {
+                    throw std::runtime_error("cannot append to snapshot with a different header: " + path);
+                }
+                written = existing.size();
+                recordsEnd = sizeof(FileHeader) + written * sizeof(Record);
+            }
+            // Work on a copy without the string table; it is rewritten after
+            // the new records
+            try {
+                std::filesystem::copy_file(path, partPath, std::filesystem::copy_options::overwrite_existing);
+                std::filesystem::resize_file(partPath, recordsEnd);
+            } catch (...) {
+                discard();
+                throw;
+            }
+            file.open(partPath, std::ios::binary | std::ios::in | std::ios::out);
+        } else {
+            file.open(partPath, std::ios::binary | std::ios::out | std::ios::trunc);
+        }
+        if (!file) {
+            discard();
+            throw std::runtime_error("cannot write snapshot " + path);
+        }
+        writeHeader(false, 0, 0, 0);
+        file.seekp(0, std::ios::end);
+        pending.reserve(BATCH);
+    }
+
+    ~Writer() {
+        if (finished) {
+            return;
+        }
+        if (std::uncaught_exceptions() != exceptionsAtStart) {
+            discard(); // records added before the failure are incomplete
+            return;
+        }
+        try {
+            finish();
+        } catch (...) {
+            // finish() already discarded the partial file
+        }
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // Any {id, type, state} control
+    template <typename C>
+    void add(const C& control) {
+        pending.push_back({static_cast<int32_t>(control.id), intern(control.type), intern(control.state)});
+        if (pending.size() == BATCH) {
+            flush();
+        }
+    }
+
+    template <typename Iterator>
+    void add(Iterator first, Iterator last) {
+        for (; first != last; ++first) {
+            add(*first);
+        }
+    }
+
+    // Writes the records added so far
+    void flush() {
+        if (pending.empty()) {
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(pending.data()),
+                   static_cast<std::streamsize>(pending.size() * sizeof(Record)));
+        written += pending.size();
+        pending.clear();
+        if (!file) {
+            throw std::runtime_error("cannot write snapshot " + path);
+        }
+    }
+
+    // Writes the string table, marks the snapshot complete and moves it into
+    // place
+    void finish() {
+        if (finished) {
+            return;
+        }
+        try {
+            writeStrings();
+        } catch (...) {
+            discard(); // the previous snapshot stays in place
+            throw;
+        }
+        finished = true;
+    }
+
+    size_t size() const { return static_cast<size_t>(written) + pending.size(); }
+
+private:
+    static const size_t BATCH = 4096;
+
+    std::string path;
+    std::string partPath; // written in place of path until finish()
+    int exceptionsAtStart;
+    std::fstream file;
+    std::vector<Record> pending;
+    uint64_t written = 0;
+    std::deque<std::string> interned;                      // keeps the keys below valid
+    std::unordered_map<std::string_view, uint16_t> codes;
+    bool finished = false;
+
+    uint16_t intern(std::string_view text) {
+        auto found = codes.find(text);
+        if (found != codes.end()) {
+            return found->second;
+        }
+        if (interned.size() > UINT16_MAX) {
+            throw std::runtime_error("too many distinct strings for snapshot " + path);
+        }
+        uint16_t code = static_cast<uint16_t>(interned.size());
+        interned.emplace_back(text);
+        codes.emplace(interned.back(), code);
+        return code;
+    }
+
+    void writeStrings() {
+        flush();
+        uint64_t stringsOffset = sizeof(FileHeader) + written * sizeof(Record);
+        uint32_t charOffset = 0;
+        for (const std::string& text : interned) {
+            StringEntry entry{charOffset, static_cast<uint32_t>(text.size())};
+            file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            charOffset += entry.length;
+        }
+        for (const std::string& text : interned) {
+            file.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+        uint64_t charsOffset = stringsOffset + interned.size() * sizeof(StringEntry);
+        writeHeader(true, stringsOffset, charsOffset, charsOffset + charOffset);
+        file.close();
+        if (!file) {
+            throw std::runtime_error("cannot write snapshot " + path);
+        }
+        std::filesystem::rename(partPath, path);
+    }
+
+    void discard() {
+        finished = true;
+        file.close();
+        std::error_code ignored;
+        std::filesystem::remove(partPath, ignored);
+    }
+
+    void writeHeader(bool complete, uint64_t stringsOffset, uint64_t charsOffset, uint64_t fileBytes) {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = FORMAT_VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.headerBytes = sizeof(FileHeader);
+        header.complete = complete ? 1 : 0;
+        header.recordCount = written;
+        header.recordsOffset = sizeof(FileHeader);
+        header.stringsOffset = stringsOffset;
+        header.stringCount = interned.size();
+        header.charsOffset = charsOffset;
+        header.fileBytes = fileBytes;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+};
+
+} // namespace snapshot
+
+#endif // CONTROL_SNAPSHOT_H
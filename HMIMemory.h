@@ -0,0 +1,270 @@
+/* HMI Memory Accounting
+std::pmr memory resources that count what each HMI subsystem allocates.
+Every TrackingResource has a subsystem name; the registry adds up live bytes,
+peak bytes and allocation counts per name, and a resource can be given a cap
+on its live bytes (allocations beyond it throw std::bad_alloc).
+
+Two ready-made kinds of resource sit on top:
+    Pool       size-class pools (std::pmr::synchronized_pool_resource) for
+               objects with independent lifetimes
+    FrameArena monotonic arena for everything built during one screen or
+               frame, released in one step with reset()
+
+Usage:
+    hmimem::Pool themes("themes");
+    std::pmr::vector<Theme*> list(&themes);
+    auto classic = hmimem::makeUnique<Classic>(themes, ...);
+    hmimem::report(std::cout);   // one line per subsystem
+*/
+
+#ifndef HMI_MEMORY_H
+#define HMI_MEMORY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hmimem {
+
+class TrackingResource;
+
+struct SubsystemStats {
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;      // sum of the live resources' peaks, or the largest retired one
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+};
+
+// Every live TrackingResource, so stats can be reported by subsystem
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    void add(TrackingResource* resource) {
+        std::lock_guard<std::mutex> lock(mtx);
+        resources.push_back(resource);
+    }
+
+    // Folds the final counts into the subsystem's retired totals
+    void remove(TrackingResource* resource);
+
+    std::map<std::string, SubsystemStats> stats() const;
+
+private:
+    mutable std::mutex mtx;
+    std::vector<TrackingResource*> resources;
+    std::map<std::string, SubsystemStats> retired;
+
+    Registry() = default;
+};
+
+// Counts allocations passed on to `upstream`
+class TrackingResource : public std::pmr::memory_resource {
+public:
+    explicit TrackingResource(std::string subsystem,
+                              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : subsystemName(std::move(subsystem)), upstream(upstream) {
+        Registry::instance().add(this);
+    }
+
+    ~TrackingResource() override { Registry::instance().remove(this); }
+
+    TrackingResource(const TrackingResource&) = delete;
+    TrackingResource& operator=(const TrackingResource&) = delete;
+
+    // 0 (the default) means no cap
+    void setLimit(size_t bytes) { limit.store(bytes, std::memory_order_relaxed); }
+
+    // For resources whose upstream frees everything at once (FrameArena)
+    void forgetAll() { live.store(0, std::memory_order_relaxed); }
+
+    const std::string& subsystem() const { return subsystemName; }
+    size_t liveBytes() const { return live.load(std::memory_order_relaxed); }
+    size_t peakBytes() const { return peak.load(std::memory_order_relaxed); }
+    uint64_t allocationCount() const { return allocations.load(std::memory_order_relaxed); }
+    uint64_t deallocationCount() const { return deallocations.load(std::memory_order_relaxed); }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        size_t cap = limit.load(std::memory_order_relaxed);
+        size_t now = live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (cap != 0 && now > cap) {
+            live.fetch_sub(bytes, std::memory_order_relaxed);
+            throw std::bad_alloc();
+        }
+        void* memory;
+        try {
+            memory = upstream->allocate(bytes, alignment);
+        } catch (...) {
+            live.fetch_sub(bytes, std::memory_order_relaxed);
+            throw;
+        }
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t previousPeak = peak.load(std::memory_order_relaxed);
+        while (now > previousPeak && !peak.compare_exchange_weak(previousPeak, now, std::memory_order_relaxed)) {
+        }
+        return memory;
+    }
+
+    void do_deallocate(void* memory, size_t bytes, size_t alignment) override {
+        upstream->deallocate(memory, bytes, alignment);
+        live.fetch_sub(bytes, std::memory_order_relaxed);
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    std::string subsystemName;
+    std::pmr::memory_resource* upstream;
+    std::atomic<size_t> live{0};
+    std::atomic<size_t> peak{0};
+    std::atomic<size_t> limit{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+};
+
+inline void Registry::remove(TrackingResource* resource) {
+    std::lock_guard<std::mutex> lock(mtx);
+    resources.erase(std::remove(resources.begin(), resources.end(), resource), resources.end());
+    SubsystemStats& total = retired[resource->subsystem()];
+    total.peakBytes = std::max(total.peakBytes, resource->peakBytes());
+    total.allocations += resource->allocationCount();
+    total.deallocations += resource->deallocationCount();
+}
+
+inline std::map<std::string, SubsystemStats> Registry::stats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::map<std::string, SubsystemStats> result = retired;
+    std::map<std::string, size_t> livePeaks;
+    for (const TrackingResource* resource : resources) {
+        SubsystemStats& total = result[resource->subsystem()];
+        total.liveBytes += resource->liveBytes();
+        total.allocations += resource->allocationCount();
+        total.deallocations += resource->deallocationCount();
+        livePeaks[resource->subsystem()] += resource->peakBytes();
+    }
+    for (const auto& entry : livePeaks) {
+        result[entry.first].peakBytes = std::max(result[entry.first].peakBytes, entry.second);
+    }
+    return result;
+}
+
+// Size-class pools for one subsystem; safe to use from several threads
+class Pool : public std::pmr::memory_resource {
+public:
+    explicit Pool(std::string subsystem) : tracker(std::move(subsystem), &pools) {}
+
+    TrackingResource& tracking() { return tracker; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override { return tracker.allocate(bytes, alignment); }
+    void do_deallocate(void* memory, size_t bytes, size_t alignment) override {
+        tracker.deallocate(memory, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    std::pmr::synchronized_pool_resource pools;
+    TrackingResource tracker;   // counts every allocation served by the pools
+};
+
+// Monotonic arena for one screen or frame. Allocations are a pointer bump,
+// deallocation is a no-op and reset() gives everything back at once. The
+// counts are per allocation, not per block. Not thread-safe.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(std::string subsystem, size_t initialBytes = 64 * 1024)
+        : arena(initialBytes), tracker(std::move(subsystem), &arena) {}
+
+    // Every object allocated from the arena must be gone by now
+    void reset() {
+        arena.release();
+        tracker.forgetAll();
+    }
+
+    TrackingResource& tracking() { return tracker; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override { return tracker.allocate(bytes, alignment); }
+    void do_deallocate(void* memory, size_t bytes, size_t alignment) override {
+        tracker.deallocate(memory, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    std::pmr::monotonic_buffer_resource arena;
+    TrackingResource tracker;
+};
+
+// Destroys and frees an object made by makeUnique
+template <typename T>
+class Deleter {
+public:
+    Deleter(std::pmr::memory_resource* resource = nullptr, size_t size = sizeof(T), size_t alignment = alignof(T))
+        : resource(resource), size(size), alignment(alignment) {}
+
+    // Converting from a derived type keeps the derived object's size
+    template <typename U>
+    Deleter(const Deleter<U>& other) : resource(other.resource), size(other.size), alignment(other.alignment) {}
+
+    void operator()(T* object) const {
+        object->~T();
+        resource->deallocate(const_cast<void*>(static_cast<const void*>(object)), size, alignment);
+    }
+
+private:
+    template <typename U>
+    friend class Deleter;
+
+    std::pmr::memory_resource* resource;
+    size_t size;
+    size_t alignment;
+};
+
+template <typename T>
+using UniquePtr = std::unique_ptr<T, Deleter<T>>;
+
+// unique_ptr whose object lives in `resource`; a base-class UniquePtr can
+// own it when T has a virtual destructor
+template <typename T, typename... Args>
+UniquePtr<T> makeUnique(std::pmr::memory_resource& resource, Args&&... args) {
+    void* memory = resource.allocate(sizeof(T), alignof(T));
+    try {
+        return UniquePtr<T>(new (memory) T(std::forward<Args>(args)...), Deleter<T>(&resource));
+    } catch (...) {
+        resource.deallocate(memory, sizeof(T), alignof(T));
+        throw;
+    }
+}
+
+// One line per subsystem: live/peak bytes and allocation counts
+inline void report(std::ostream& out) {
+    out << "---- memory by subsystem ----" << std::endl;
+    out << std::left << std::setw(16) << "subsystem" << std::right << std::setw(12) << "live B" << std::setw(12)
+        << "peak B" << std::setw(12) << "allocs" << std::setw(12) << "frees" << std::endl;
+    for (const auto& entry : Registry::instance().stats()) {
+        const SubsystemStats& stats = entry.second;
+        out << std::left << std::setw(16) << entry.first << std::right << std::setw(12) << stats.liveBytes
+            << std::setw(12) << stats.peakBytes << std::setw(12) << stats.allocations << std::setw(12)
+            << stats.deallocations << std::endl;
+    }
+}
+
+} // namespace hmimem
+
+#endif // HMI_MEMORY_H
@@ -0,0 +1,274 @@
+/* HMI Frame-Time Profiler
+Scoped timers for the HMI programs. Each thread writes its samples into its own
+ring buffer, so recording takes no locks. When a thread exits, its samples are
+moved to a bounded store and its ring is reused by the next new thread, so
+short-lived threads do not add a ring each. At the end of a run the samples are
+aggregated into per-name histograms (count, p50, p99, max) and exported as a
+Chrome trace (open it in chrome://tracing or https://ui.perfetto.dev).
+
+Profiling is off by default: build with -DHMI_PROFILING to enable it. Without
+that flag every macro below expands to nothing and costs nothing.
+
+Usage:
+    void render() {
+        HMI_PROFILE_SCOPE("HMIRenderer::render");
+        ...
+    }
+    HMI_PROFILE_REPORT("prgm9_trace.json"); // summary to stderr + trace file
+*/
+
+#ifndef HMI_PROFILER_H
+#define HMI_PROFILER_H
+
+#ifdef HMI_PROFILING
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hmiprof {
+
+struct Sample {
+    const char* name;     // string literal passed to HMI_PROFILE_SCOPE
+    uint64_t startNs;     // since profiler start
+    uint64_t durationNs;
+};
+
+// Fixed-size ring owned by one thread at a time; old samples are overwritten
+// when full
+class ThreadRing {
+public:
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    explicit ThreadRing(uint32_t threadId) : threadId(threadId), samples(CAPACITY) {}
+
+    // Hands an emptied ring to a new thread
+    void reset(uint32_t newThreadId) {
+        threadId = newThreadId;
+        written.store(0, std::memory_order_relaxed);
+    }
+
+    void push(const Sample& sample) {
+        uint64_t index = written.load(std::memory_order_relaxed);
+        samples[index & (CAPACITY - 1)] = sample;
+        written.store(index + 1, std::memory_order_release);
+    }
+
+    // Only consistent once the owning thread has stopped recording
+    std::vector<Sample> snapshot() const {
+        uint64_t count = written.load(std::memory_order_acquire);
+        uint64_t first = count > CAPACITY ? count - CAPACITY : 0;
+        std::vector<Sample> result;
+        result.reserve(static_cast<size_t>(count - first));
+        for (uint64_t i = first; i < count; i++) {
+            result.push_back(samples[i & (CAPACITY - 1)]);
+        }
+        return result;
+    }
+
+    uint32_t threadId;
+
+private:
+    std::vector<Sample> samples;
+    std::atomic<uint64_t> written{0};
+};
+
+class Profiler {
+public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    uint64_t nowNs() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count());
+    }
+
+    // The calling thread's ring, registered on first use and retired when
+    // the thread exits
+    ThreadRing& localRing() {
+        thread_local RingOwner owner(*this);
+        return *owner.ring;
+    }
+
+    // Per-name histogram summary, times in microseconds
+    void report(std::ostream& out) const {
+        std::map<std::string, std::vector<uint64_t>> durations;
+        for (const auto& sample : collect()) {
+            durations[sample.name].push_back(sample.durationNs);
+        }
+
+        out << "---- HMI profile (us) ----" << std::endl;
+        out << std::left << std::setw(32) << "scope" << std::right << std::setw(10) << "count"
+            << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+        out << std::fixed << std::setprecision(1);
+        for (auto& entry : durations) {
+            std::vector<uint64_t>& values = entry.second;
+            std::sort(values.begin(), values.end());
+            out << std::left << std::setw(32) << entry.first << std::right << std::setw(10) << values.size()
+                << std::setw(12) << percentile(values, 50) / 1000.0
+                << std::setw(12) << percentile(values, 99) / 1000.0
+                << std::setw(12) << values.back() / 1000.0 << std::endl;
+        }
+    }
+
+    // Chrome trace-event JSON: one complete ("X") event per sample
+    bool writeChromeTrace(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        out << std::fixed << std::setprecision(3);
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& traced : collectTraced()) {
+            const Sample& sample = traced.sample;
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"" << escape(sample.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << traced.threadId
+                << ",\"ts\":" << sample.startNs / 1000.0 << ",\"dur\":" << sample.durationNs / 1000.0 << "}";
+        }
+        out << "\n]}" << std::endl;
+        return static_cast<bool>(out);
+    }
+
+private:
+    // Samples kept from exited threads; the oldest are dropped beyond this
+    static constexpr size_t RETIRED_CAPACITY = 1 << 16;
+
+    struct TracedSample {
+        Sample sample;
+        uint32_t threadId;
+    };
+
+    // Ties a ring to the lifetime of its thread
+    struct RingOwner {
+        Profiler& profiler;
+        ThreadRing* ring;
+
+        explicit RingOwner(Profiler& profiler) : profiler(profiler), ring(profiler.registerThread()) {}
+        ~RingOwner() { profiler.retire(ring); }
+    };
+
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    mutable std::mutex mtx; // guards registration and retirement only, never recording
+    std::vector<std::unique_ptr<ThreadRing>> rings;      // owned by running threads
+    std::vector<std::unique_ptr<ThreadRing>> freeRings;  // drained, ready for reuse
+    std::deque<TracedSample> retired;
+    uint32_t nextThreadId = 1;
+
+    Profiler() = default;
+
+    ThreadRing* registerThread() {
+        std::lock_guard<std::mutex> lock(mtx);
+        uint32_t threadId = nextThreadId++;
+        if (freeRings.empty()) {
+            rings.push_back(std::make_unique<ThreadRing>(threadId));
+        } else {
+            rings.push_back(std::move(freeRings.back()));
+            freeRings.pop_back();
+            rings.back()->reset(threadId);
+        }
+        return rings.back().get();
+    }
+
+    // Called by the owning thread as it exits: keep its samples, free its ring
+    void retire(ThreadRing* ring) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& sample : ring->snapshot()) {
+            retired.push_back({sample, ring->threadId});
+        }
+        while (retired.size() > RETIRED_CAPACITY) {
+            retired.pop_front();
+        }
+        auto owned = std::find_if(rings.begin(), rings.end(),
+                                  [ring](const std::unique_ptr<ThreadRing>& r) { return r.get() == ring; });
+        freeRings.push_back(std::move(*owned));
+        rings.erase(owned);
+    }
+
+    std::vector<TracedSample> collectTraced() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::vector<TracedSample> all(retired.begin(), retired.end());
+        for (const auto& ring : rings) {
+            for (const auto& sample : ring->snapshot()) {
+                all.push_back({sample, ring->threadId});
+            }
+        }
+        return all;
+    }
+
+    std::vector<Sample> collect() const {
+        std::vector<Sample> all;
+        for (const auto& traced : collectTraced()) {
+            all.push_back(traced.sample);
+        }
+        return all;
+    }
+
+    // Nearest-rank percentile of sorted values
+    static uint64_t percentile(const std::vector<uint64_t>& sorted, unsigned p) {
+        size_t rank = (sorted.size() * p + 99) / 100;
+        return sorted[rank == 0 ? 0 : rank - 1];
+    }
+
+    static std::string escape(const char* text) {
+        std::string result;
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\') {
+                result += '\\';
+            }
+            result += *c;
+        }
+        return result;
+    }
+};
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name) : name(name), startNs(Profiler::instance().nowNs()) {}
+
+    ~ScopedTimer() {
+        Profiler& profiler = Profiler::instance();
+        uint64_t endNs = profiler.nowNs();
+        profiler.localRing().push({name, startNs, endNs - startNs});
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* name;
+    uint64_t startNs;
+};
+
+} // namespace hmiprof
+
+#define HMI_PROFILE_CONCAT_INNER(a, b) a##b
+#define HMI_PROFILE_CONCAT(a, b) HMI_PROFILE_CONCAT_INNER(a, b)
+#define HMI_PROFILE_SCOPE(name) hmiprof::ScopedTimer HMI_PROFILE_CONCAT(hmiProfileScope, __LINE__)(name)
+#define HMI_PROFILE_REPORT(tracePath)                                   \
+    do {                                                                \
+        hmiprof::Profiler::instance().report(std::cerr);                \
+        hmiprof::Profiler::instance().writeChromeTrace(tracePath);      \
+    } while (0)
+
+#else
+
+#define HMI_PROFILE_SCOPE(name) ((void)0)
+#define HMI_PROFILE_REPORT(tracePath) ((void)0)
+
+#endif // HMI_PROFILING
+
+#endif // HMI_PROFILER_H
@@ -0,0 +1,213 @@
+/* Headless Driver for the Interactive Programs
+Lets the console programs run without a user: input comes from a script file
+or from a generator, sleeps advance a virtual clock instead of blocking, and
+program output is discarded. At the end the driver prints throughput and
+per-interaction latency (p50/p99/max) so menu and theme logic can be
+soak-tested with millions of interactions.
+
+Command line:
+    --headless              enable headless mode
+    --script=path           read input tokens from a file
+    --generate=N            generate N random input tokens (default 100000)
+    --seed=S                seed for generated input (default 1)
+
+Interactive runs (no --headless) behave exactly as before: std::cin is used
+and sleeps are real.
+*/
+
+#ifndef HEADLESS_DRIVER_H
+#define HEADLESS_DRIVER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace headless {
+
+struct Options {
+    bool enabled = false;
+    std::string scriptPath;
+    size_t generate = 100000;
+    unsigned seed = 1;
+};
+
+inline Options& options() {
+    static Options current;
+    return current;
+}
+
+inline bool enabled() { return options().enabled; }
+
+// Returns false (after printing usage) on an unknown argument
+inline bool parseOptions(int argc, char** argv) {
+    Options& opts = options();
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            opts.enabled = true;
+        } else if (arg.rfind("--script=", 0) == 0) {
+            opts.scriptPath = arg.substr(9);
+        } else if (arg.rfind("--generate=", 0) == 0) {
+            opts.generate = static_cast<size_t>(std::strtoull(arg.c_str() + 11, nullptr, 10));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            opts.seed = static_cast<unsigned>(std::strtoul(arg.c_str() + 7, nullptr, 10));
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--headless [--script=path | --generate=N] [--seed=S]]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Time "slept" on the virtual clock so far
+inline std::chrono::nanoseconds& virtualElapsed() {
+    static std::chrono::nanoseconds elapsed{0};
+    return elapsed;
+}
+
+// Real sleep interactively, virtual clock advance when headless
+template <typename Rep, typename Period>
+void sleepFor(const std::chrono::duration<Rep, Period>& duration) {
+    if (enabled()) {
+        virtualElapsed() += std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+    } else {
+        std::this_thread::sleep_for(duration);
+    }
+}
+
+// Input stream buffer that produces one generated token per line on demand,
+// so millions of interactions need no pre-built input
+class GeneratedInput : public std::streambuf {
+    std::function<std::string()> next;
+    size_t remaining;
+    std::string line;
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        if (remaining == 0) {
+            return traits_type::eof();
+        }
+        remaining--;
+        line = next() + "\n";
+        setg(&line[0], &line[0], &line[0] + line.size());
+        return traits_type::to_int_type(line[0]);
+    }
+
+public:
+    GeneratedInput(std::function<std::string()> next, size_t count) : next(std::move(next)), remaining(count) {}
+};
+
+// One headless run: owns the input source, silences std::cout and records
+// the time taken by each interaction
+class Session {
+public:
+    using Generator = std::function<std::string(std::mt19937&)>;
+
+    explicit Session(Generator generator) : random(options().seed) {
+        if (!enabled()) {
+            return;
+        }
+        if (!options().scriptPath.empty()) {
+            script.open(options().scriptPath);
+            if (!script) {
+                std::cerr << "cannot open script " << options().scriptPath << std::endl;
+                std::exit(1);
+            }
+        } else {
+            generated.reset(new GeneratedInput([this, generator] { return generator(random); },
+                                               options().generate));
+            generatedStream.reset(new std::istream(generated.get()));
+        }
+        savedOutput = std::cout.rdbuf(&discard);
+        start = last = std::chrono::steady_clock::now();
+    }
+
+    ~Session() { finish(); }
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    std::istream& input() {
+        if (!enabled()) {
+            return std::cin;
+        }
+        if (generatedStream) {
+            return *generatedStream;
+        }
+        return script;
+    }
+
+    // Call once per consumed input; records the time since the previous one
+    void tick() {
+        if (!enabled()) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        latenciesNs.push_back(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count()));
+        last = now;
+    }
+
+    // Restore output and print the throughput/latency summary
+    void finish() {
+        if (!enabled() || finished) {
+            return;
+        }
+        finished = true;
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout.rdbuf(savedOutput);
+
+        std::sort(latenciesNs.begin(), latenciesNs.end());
+        auto percentile = [this](unsigned p) -> double {
+            if (latenciesNs.empty()) {
+                return 0.0;
+            }
+            size_t rank = (latenciesNs.size() * p + 99) / 100;
+            return latenciesNs[rank == 0 ? 0 : rank - 1] / 1000.0;
+        };
+
+        std::cout << "---- headless run ----" << std::endl << std::fixed << std::setprecision(3);
+        std::cout << "interactions:        " << latenciesNs.size() << std::endl;
+        std::cout << "wall time:           " << wallSeconds << " s" << std::endl;
+        std::cout << "throughput:          " << (wallSeconds > 0 ? latenciesNs.size() / wallSeconds : 0.0)
+                  << " interactions/s" << std::endl;
+        std::cout << "latency p50/p99/max: " << percentile(50) << " / " << percentile(99) << " / "
+                  << percentile(100) << " us" << std::endl;
+        std::cout << "virtual time slept:  "
+                  << std::chrono::duration<double>(virtualElapsed()).count() << " s" << std::endl;
+    }
+
+private:
+    struct DiscardBuffer : std::streambuf {
+        int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    std::mt19937 random;
+    std::ifstream script;
+    std::unique_ptr<GeneratedInput> generated;
+    std::unique_ptr<std::istream> generatedStream;
+    DiscardBuffer discard;
+    std::streambuf* savedOutput = nullptr;
+    std::chrono::steady_clock::time_point start, last;
+    std::vector<uint64_t> latenciesNs;
+    bool finished = false;
+};
+
+} // namespace headless
+
+#endif // HEADLESS_DRIVER_H
@@ -151,72 +151,308 @@ int main() {
 
 #include<iostream>
 #include<vector>
+#include<array>
+#include<string>
+#include<algorithm>
+#include<cstdint>
+#include "HMIProfiler.h"
+#include "HeadlessDriver.h"
 
 using namespace std;
+
+/*Compile-time menu definition
+Menus are declared with nested menu()/item() calls that the compiler folds
+into a static read-only table: the nodes in pre-order plus, for every node,
+a contiguous list of its children. Nothing is allocated at startup, and a
+node can only be written as an argument of its parent, so unattached or
+dangling nodes cannot be declared.*/
+
+// Lists bound at runtime with bindMenuList()
+enum menuListId : uint32_t{
+    noList = 0,
+    songList = 1
+};
+
 struct menuNode{
-    string data ;
-    vector<menuNode*> child;
- 
-    menuNode(string data){
-        this->data = data;
+    const char *data;
+    uint32_t subtreeSize;      // this node plus all of its descendants
+    uint32_t childCount;
+    uint32_t firstChildSlot;   // first entry of this node's children in childSlots
+    uint32_t listId;           // non-zero: children come from a menuProvider (see list())
+};
+
+template<size_t N>
+struct menuTable{
+    array<menuNode, N> nodes{};
+    array<uint32_t, N> childSlots{};   // every node but the root is one child: N-1 used
+
+    // Checked with static_assert on every declared menu
+    constexpr bool valid() const{
+        if(nodes[0].subtreeSize != N){
+            return false;
+        }
+        size_t children = 0;
+        for(size_t i = 0; i < N; i++){
+            if(nodes[i].data == nullptr || nodes[i].data[0] == '\0'){
+                return false;
+            }
+            children += nodes[i].childCount;
+        }
+        return children == N - 1;
     }
-    void addchild(menuNode *data){
-        child.push_back(data);
-    }  
 };
+
+// Fill in childCount/firstChildSlot from the pre-order subtree sizes
+template<size_t N>
+constexpr void linkChildren(menuTable<N> &table){
+    uint32_t slot = 0;
+    for(uint32_t i = 0; i < N; i++){
+        table.nodes[i].firstChildSlot = slot;
+        table.nodes[i].childCount = 0;
+        for(uint32_t c = i + 1; c < i + table.nodes[i].subtreeSize; c += table.nodes[c].subtreeSize){
+            table.childSlots[slot++] = c;
+            table.nodes[i].childCount++;
+        }
+    }
+}
+
+template<size_t N, size_t M>
+constexpr void appendSubtree(menuTable<N> &table, const menuTable<M> &subtree, size_t &offset){
+    for(size_t i = 0; i < M; i++){
+        table.nodes[offset + i] = subtree.nodes[i];
+    }
+    offset += M;
+}
+
+template<size_t... Sizes>
+constexpr menuTable<1 + (0 + ... + Sizes)> menu(const char *data, const menuTable<Sizes>&... children){
+    menuTable<1 + (0 + ... + Sizes)> table;
+    table.nodes[0] = {data, 1 + (0 + ... + Sizes), 0, 0, noList};
+    [[maybe_unused]] size_t offset = 1;   // unused for leaf items
+    (appendSubtree(table, children, offset), ...);
+    linkChildren(table);
+    return table;
+}
+
+constexpr menuTable<1> item(const char *data){
+    return menu(data);
+}
+
+// Leaf whose (possibly very many) entries come from the provider bound to listId
+constexpr menuTable<1> list(const char *data, uint32_t listId){
+    menuTable<1> table = menu(data);
+    table.nodes[0].listId = listId;
+    return table;
+}
+
+// Size-independent handle on a menu table, used by the display code
+struct menuView{
+    const menuNode *nodes;
+    const uint32_t *childSlots;
+
+    const char *data(uint32_t node) const{ return nodes[node].data; }
+    uint32_t childCount(uint32_t node) const{ return nodes[node].childCount; }
+    uint32_t child(uint32_t node, uint32_t index) const{ return childSlots[nodes[node].firstChildSlot + index]; }
+    uint32_t listId(uint32_t node) const{ return nodes[node].listId; }
+};
+
+template<size_t N>
+constexpr menuView viewOf(const menuTable<N> &table){
+    return {table.nodes.data(), table.childSlots.data()};
+}
+
+/*Virtualized lists
+Media menus (songs, contacts) can have tens of thousands of entries, so they
+are not part of the static table. A menuProvider produces entry labels by
+index, and a virtualList shows only a window of them. Labels are loaded on
+first access into a cache that covers the window plus a prefetch margin on
+each side, so scrolling costs time proportional to the window and memory
+stays bounded however long the list is.*/
+
+class menuProvider{
+public:
+    virtual uint32_t size() const = 0;
+    virtual string label(uint32_t index) const = 0;
+    virtual ~menuProvider(){}
+};
+
+// Providers bound to the list IDs used in the menu tables
+vector<const menuProvider*> &menuLists(){
+    static vector<const menuProvider*> lists;
+    return lists;
+}
+
+void bindMenuList(uint32_t listId, const menuProvider &provider){
+    if(menuLists().size() <= listId){
+        menuLists().resize(listId + 1, nullptr);
+    }
+    menuLists()[listId] = &provider;
+}
+
+class virtualList{
+    const menuProvider &provider;
+    uint32_t viewport;
+    uint32_t margin;
+    uint32_t top = 0;
+    uint32_t loads = 0;
+    // Direct-mapped by index: the window plus both margins never collide
+    vector<pair<uint32_t, string>> cache;
+
+public:
+    virtualList(const menuProvider &provider, uint32_t viewport = 10, uint32_t margin = 10)
+        : provider(provider), viewport(viewport), margin(margin), cache(viewport + 2 * margin, {UINT32_MAX, ""}){}
+
+    const string &label(uint32_t index){
+        pair<uint32_t, string> &slot = cache[index % cache.size()];
+        if(slot.first != index){
+            slot = {index, provider.label(index)};
+            loads++;
+        }
+        return slot.second;
+    }
+
+    void scrollBy(long rows){
+        long last = max<long>(0, static_cast<long>(provider.size()) - viewport);
+        top = static_cast<uint32_t>(min(max(static_cast<long>(top) + rows, 0L), last));
+    }
+
+    uint32_t pageSize() const{ return viewport; }
+    uint32_t size() const{ return provider.size(); }
+    uint32_t labelsLoaded() const{ return loads; }
+
+    void render(){
+        uint32_t end = min(top + viewport, provider.size());
+        for(uint32_t i = top; i < end; i++){
+            cout<<i+1 <<". "<<label(i)<<endl;
+        }
+        cout<<"(showing "<<(end > top ? top + 1 : 0)<<"-"<<end<<" of "<<provider.size()<<")"<<endl;
+
+        // Prefetch the margins so the next scroll step is already loaded
+        for(uint32_t i = top > margin ? top - margin : 0; i < top; i++){
+            label(i);
+        }
+        for(uint32_t i = end; i < min(end + margin, provider.size()); i++){
+            label(i);
+        }
+    }
+};
+
+constexpr auto mainMenu = menu("Main menu",
+    menu("settings",
+        item("Display settings"),
+        item("Audio settings")),
+    menu("media",
+        item("Radio"),
+        item("Bluethoo"),
+        list("Songs", songList)));
+
+static_assert(mainMenu.valid(), "main menu table is malformed");
  
  
-void displayMenu(menuNode *menu){
-     cout<<" == "<<menu->data<<" == "<<endl;
-     if(menu->data.empty()){
+void displayMenu(const menuView &menu, uint32_t node){
+     cout<<" == "<<menu.data(node)<<" == "<<endl;
+     if(menu.childCount(node) == 0){
         cout<<"No sub menu available...."<<endl;
      }else{
-        for(auto  i = 0 ; i < menu->child.size(); i++){
-            cout<<i+1 <<". "<<menu->child[i]->data<<endl;
+        for(uint32_t i = 0 ; i < menu.childCount(node); i++){
+            cout<<i+1 <<". "<<menu.data(menu.child(node, i))<<endl;
         }
      }  
 }
-void navigate(menuNode *menu){
+
+// Browse a provider-backed list one page at a time
+void browseList(const char *data, const menuProvider &provider, headless::Session &session){
+    virtualList entries(provider);
+    int choice ;
+    while(true){
+        {
+            HMI_PROFILE_SCOPE("browseList/render");
+            cout<<" == "<<data<<" == "<<endl;
+            entries.render();
+        }
+        cout<<"Choose an entry(enter 0 to go back, -1 next page, -2 previous page): "<<endl;
+        if(!(session.input()>>choice)){
+            break;   // end of input
+        }
+        session.tick();
+
+        if(choice == 0){
+            cout<<"Going back... "<<endl;
+            break;
+        }
+        if(choice == -1 || choice == -2){
+            entries.scrollBy(choice == -1 ? entries.pageSize() : -static_cast<long>(entries.pageSize()));
+        }else if(choice < 1 || static_cast<uint32_t>(choice) > entries.size()){
+            cout<<"Invalid choice..."<<endl;
+        }else{
+            cout<<"Selected "<<entries.label(choice-1)<<endl;
+        }
+    }
+}
+
+void navigate(const menuView &menu, uint32_t node, headless::Session &session){
+   uint32_t listId = menu.listId(node);
+   if(listId != noList && listId < menuLists().size() && menuLists()[listId] != nullptr){
+       browseList(menu.data(node), *menuLists()[listId], session);
+       return;
+   }
    int choice ;
      while(true){
-           displayMenu(menu);
+           {
+               HMI_PROFILE_SCOPE("navigate/displayMenu");
+               displayMenu(menu, node);
+           }
            cout<<"Choose an option(enter 0 to go back): "<<endl;
-           cin>>choice;
+           if(!(session.input()>>choice)){
+            break;   // end of input
+           }
+           session.tick();
  
            if(choice == 0){
             cout<<"Going back... "<<endl;
             break;
            }
            
-        if(choice <1 || choice > menu->child.size()){
+        if(choice <1 || static_cast<uint32_t>(choice) > menu.childCount(node)){
             cout<<"Invalid choice..."<<endl;
         }else{
-            cout << "Navigating to " << menu->child[choice-1]->data << "...\n";
-            navigate(menu->child[choice]);
+            uint32_t selected = menu.child(node, choice-1);
+            cout << "Navigating to " << menu.data(selected) << "...\n";
+            navigate(menu, selected, session);
         }                
      }
 }
-int main(){
-    menuNode *root = new menuNode("Main menu");
-    menuNode *submenu1 = new menuNode("settings");
-    menuNode *submenu2 = new menuNode("media");
- 
-    root->addchild(submenu1);
-    root->addchild(submenu2);
-     
-    menuNode *submenu1_1 = new menuNode("Display settings");
-    menuNode *submenu1_2 = new menuNode("Audio settings");
- 
-    submenu1->addchild(submenu1_1);
-    submenu1->addchild(submenu1_2);
- 
-    menuNode *submenu2_1 = new menuNode("Radio");
-    menuNode *submenu2_2 = new menuNode("Bluethoo");
+#ifndef HMI_NO_MAIN
+int main(int argc, char **argv){
+    if(!headless::parseOptions(argc, argv)){
+        return 1;
+    }
+    // Generated input: mostly valid choices, some "back", paging and invalid ones
+    headless::Session session([](mt19937 &random){
+        return to_string(uniform_int_distribution<int>(-2, 3)(random));
+    });
+
+    // Stand-in for the media library: 50,000 songs whose names are made on demand
+    class songLibrary : public menuProvider{
+    public:
+        uint32_t size() const override{ return 50000; }
+        string label(uint32_t index) const override{ return "Song " + to_string(index + 1); }
+    } songs;
+    bindMenuList(songList, songs);
+
+    // The whole menu tree is the static mainMenu table: nothing to build here
+    const menuView root = viewOf(mainMenu);
  
-    //displayMenu(root);
+    //displayMenu(root, 0);
     cout<<"Welcome to our playlist...."<<endl;
  
-    navigate(root);
+    // Headless runs re-enter the main menu until the input is used up
+    do{
+        navigate(root, 0, session);
+    }while(headless::enabled() && session.input());
+    session.finish();
  
+    HMI_PROFILE_REPORT("prgm1_trace.json");
    return 0;
 }
+#endif
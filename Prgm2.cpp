@@ -21,6 +21,24 @@ Output showcasing real-time updates and warnings.
 #include<chrono>
 #include<cstdlib>
 #include<ctime>
+#include<atomic>
+#include<cstdint>
+#include<stdexcept>
+#include<vector>
+#include<mutex>
+#include<condition_variable>
+#include<memory>
+#include<algorithm>
+#include "HMIProfiler.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include<csignal>
+#include<new>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<unistd.h>
+#define HMI_HAS_SHARED_MEMORY 1
+#endif
 
 using namespace std;
 
@@ -55,6 +73,7 @@ class Display
     public:
     void showVehicleData(VehicleData vehicle)
     {
+        HMI_PROFILE_SCOPE("Display::showVehicleData");
         cout<<"speed: "<< vehicle.speed <<endl;
         cout<<"fuelLevel: "<< vehicle.fuelLevel <<endl;
         cout<<"enginetemperature: "<< vehicle.enginetemperature <<endl;
@@ -72,16 +91,599 @@ class Display
 };
 
 void updateAndDisplayData(VehicleData& vehicle, Display& display) {
-    while (true) {
+    for (long frame = 1; ; frame++) {
         vehicle.updatevehicleData();  
         display.showVehicleData(vehicle);  
 
+        // The loop never ends, so publish the profile periodically
+        if (frame % 10 == 0) {
+            HMI_PROFILE_REPORT("prgm2_trace.json");
+        }
+
         
         this_thread::sleep_for(chrono::seconds(3));
     }
 }
-int main()
+/*Fleet simulation
+Simulates many vehicles at once for back-end testing. Vehicle state is kept
+as structure-of-arrays chunks of CHUNK_SIZE vehicles, so one update pass walks
+contiguous arrays. Every step advances all vehicles by a fixed timestep. The
+chunks are split into one contiguous range per worker: the owner claims chunks
+from the front of its range and a worker that runs out steals from the back of
+another's, both with a single CAS. Warning counts are added to shared atomic
+counters once per chunk, so no locks are taken during a step.*/
+
+enum FleetWarning : uint8_t
+{
+    WARN_OVERHEAT = 1,    // engine temperature > 100
+    WARN_LOW_FUEL = 2     // fuel level < 10
+};
+
+struct FleetWarningCounts
+{
+    atomic<uint64_t> overheatRaised{0};   // transitions into the warning, all steps
+    atomic<uint64_t> lowFuelRaised{0};
+    atomic<uint64_t> overheatActive{0};   // vehicles in the warning after the last step
+    atomic<uint64_t> lowFuelActive{0};
+};
+
+class FleetSimulation
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr float TIMESTEP_SECONDS = 0.1f;
+
+private:
+    struct alignas(64) VehicleChunk
+    {
+        float speed[CHUNK_SIZE];
+        float fuelLevel[CHUNK_SIZE];
+        float enginetemperature[CHUNK_SIZE];
+        uint32_t random[CHUNK_SIZE];     // per-vehicle xorshift state
+        uint8_t warnings[CHUNK_SIZE];    // FleetWarning bits
+        size_t count;
+    };
+
+    // Chunk indices [begin, end) still to do, packed as begin << 32 | end
+    struct alignas(64) WorkRange
+    {
+        atomic<uint64_t> range{0};
+    };
+
+    vector<VehicleChunk> chunks;
+    size_t vehicleCount;
+    unsigned threadCount;
+    unique_ptr<WorkRange[]> ranges;
+    vector<thread> workers;
+    FleetWarningCounts counts;
+    atomic<uint64_t> steals{0};
+    uint64_t stepCount = 0;
+
+    mutex mtx;
+    condition_variable startCv;
+    condition_variable doneCv;
+    uint64_t generation = 0;
+    unsigned running = 0;
+    bool stopping = false;
+
+    static uint32_t nextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    static bool claimFront(WorkRange& work, uint32_t& chunk)
+    {
+        uint64_t current = work.range.load(memory_order_relaxed);
+        while (static_cast<uint32_t>(current >> 32) < static_cast<uint32_t>(current))
+        {
+            if (work.range.compare_exchange_weak(current, current + (uint64_t(1) << 32), memory_order_acq_rel,
+                                                 memory_order_relaxed))
+            {
+                chunk = static_cast<uint32_t>(current >> 32);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool claimBack(WorkRange& work, uint32_t& chunk)
+    {
+        uint64_t current = work.range.load(memory_order_relaxed);
+        while (static_cast<uint32_t>(current >> 32) < static_cast<uint32_t>(current))
+        {
+            if (work.range.compare_exchange_weak(current, current - 1, memory_order_acq_rel, memory_order_relaxed))
+            {
+                chunk = static_cast<uint32_t>(current) - 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Same rules as VehicleData/Display, but as a random walk with a fixed timestep
+    void updateChunk(VehicleChunk& chunk)
+    {
+        uint64_t overheatRaised = 0, lowFuelRaised = 0, overheatActive = 0, lowFuelActive = 0;
+        for (size_t i = 0; i < chunk.count; i++)
+        {
+            uint32_t random = nextRandom(chunk.random[i]);
+            float speed = chunk.speed[i] + static_cast<float>(static_cast<int>(random % 11) - 5);
+            speed = min(max(speed, 0.0f), 200.0f);
+            float fuel = chunk.fuelLevel[i] - speed * 0.0005f * TIMESTEP_SECONDS;
+            if (fuel < 0.0f)
+            {
+                fuel = 100.0f;   // refuelled
+            }
+            float target = 60.0f + speed * 0.25f;
+            float temperature = chunk.enginetemperature[i] + (target - chunk.enginetemperature[i]) * 0.05f +
+                                static_cast<float>(static_cast<int>((random >> 8) % 5) - 2) * 0.5f;
+
+            uint8_t warnings = static_cast<uint8_t>((temperature > 100.0f ? WARN_OVERHEAT : 0) |
+                                                    (fuel < 10.0f ? WARN_LOW_FUEL : 0));
+            uint8_t raised = static_cast<uint8_t>(warnings & ~chunk.warnings[i]);
+            overheatRaised += raised & WARN_OVERHEAT ? 1 : 0;
+            lowFuelRaised += raised & WARN_LOW_FUEL ? 1 : 0;
+            overheatActive += warnings & WARN_OVERHEAT ? 1 : 0;
+            lowFuelActive += warnings & WARN_LOW_FUEL ? 1 : 0;
+
+            chunk.speed[i] = speed;
+            chunk.fuelLevel[i] = fuel;
+            chunk.enginetemperature[i] = temperature;
+            chunk.warnings[i] = warnings;
+        }
+        counts.overheatRaised.fetch_add(overheatRaised, memory_order_relaxed);
+        counts.lowFuelRaised.fetch_add(lowFuelRaised, memory_order_relaxed);
+        counts.overheatActive.fetch_add(overheatActive, memory_order_relaxed);
+        counts.lowFuelActive.fetch_add(lowFuelActive, memory_order_relaxed);
+    }
+
+    // Own range first, then steal from the others until every range is empty
+    void work(unsigned worker)
+    {
+        uint32_t chunk;
+        while (claimFront(ranges[worker], chunk))
+        {
+            updateChunk(chunks[chunk]);
+        }
+        for (unsigned offset = 1; offset < threadCount; offset++)
+        {
+            WorkRange& victim = ranges[(worker + offset) % threadCount];
+            while (claimBack(victim, chunk))
+            {
+                steals.fetch_add(1, memory_order_relaxed);
+                updateChunk(chunks[chunk]);
+            }
+        }
+    }
+
+    void workerLoop(unsigned worker)
+    {
+        uint64_t seen = 0;
+        while (true)
+        {
+            {
+                unique_lock<mutex> lock(mtx);
+                startCv.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                {
+                    return;
+                }
+                seen = generation;
+            }
+            work(worker);
+            {
+                lock_guard<mutex> lock(mtx);
+                if (--running == 0)
+                {
+                    doneCv.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    // threads = 0 uses every hardware thread; the calling thread is one of them
+    FleetSimulation(size_t vehicles, unsigned threads = 0, uint32_t seed = 1)
+        : chunks((vehicles + CHUNK_SIZE - 1) / CHUNK_SIZE), vehicleCount(vehicles),
+          threadCount(max(1u, threads ? threads : thread::hardware_concurrency())),
+          ranges(new WorkRange[threadCount])
+    {
+        if (chunks.size() > UINT32_MAX)
+        {
+            throw runtime_error("fleet too large");
+        }
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            VehicleChunk& chunk = chunks[c];
+            chunk.count = min(CHUNK_SIZE, vehicles - c * CHUNK_SIZE);
+            for (size_t i = 0; i < chunk.count; i++)
+            {
+                uint32_t random = static_cast<uint32_t>((c * CHUNK_SIZE + i) * 2654435761u) ^ seed;
+                chunk.random[i] = random ? random : 1;   // xorshift state must not be 0
+                chunk.speed[i] = static_cast<float>(nextRandom(chunk.random[i]) % 81);
+                chunk.fuelLevel[i] = static_cast<float>(nextRandom(chunk.random[i]) % 91 + 10);
+                chunk.enginetemperature[i] = static_cast<float>(nextRandom(chunk.random[i]) % 41 + 60);
+                chunk.warnings[i] = 0;
+            }
+        }
+        for (unsigned worker = 1; worker < threadCount; worker++)
+        {
+            workers.emplace_back(&FleetSimulation::workerLoop, this, worker);
+        }
+    }
+
+    ~FleetSimulation()
+    {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        startCv.notify_all();
+        for (thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    FleetSimulation(const FleetSimulation&) = delete;
+    FleetSimulation& operator=(const FleetSimulation&) = delete;
+
+    // Advance every vehicle by one timestep
+    void step()
+    {
+        HMI_PROFILE_SCOPE("FleetSimulation::step");
+        counts.overheatActive.store(0, memory_order_relaxed);
+        counts.lowFuelActive.store(0, memory_order_relaxed);
+        uint64_t chunkCount = chunks.size();
+        for (unsigned worker = 0; worker < threadCount; worker++)
+        {
+            uint64_t begin = chunkCount * worker / threadCount;
+            uint64_t end = chunkCount * (worker + 1) / threadCount;
+            ranges[worker].range.store(begin << 32 | end, memory_order_relaxed);
+        }
+        {
+            lock_guard<mutex> lock(mtx);
+            running = threadCount - 1;
+            generation++;
+        }
+        startCv.notify_all();
+        work(0);
+        unique_lock<mutex> lock(mtx);
+        doneCv.wait(lock, [&] { return running == 0; });
+        stepCount++;
+    }
+
+    void run(size_t steps)
+    {
+        for (size_t i = 0; i < steps; i++)
+        {
+            step();
+        }
+    }
+
+    size_t size() const { return vehicleCount; }
+    unsigned threads() const { return threadCount; }
+    uint64_t steps() const { return stepCount; }
+    uint64_t stolenChunks() const { return steals.load(memory_order_relaxed); }
+    const FleetWarningCounts& warnings() const { return counts; }
+
+    uint8_t warningsOf(size_t vehicle) const
+    {
+        return chunks[vehicle / CHUNK_SIZE].warnings[vehicle % CHUNK_SIZE];
+    }
+
+    VehicleData vehicle(size_t index) const
+    {
+        const VehicleChunk& chunk = chunks[index / CHUNK_SIZE];
+        size_t i = index % CHUNK_SIZE;
+        VehicleData vehicle;
+        vehicle.speed = static_cast<int>(chunk.speed[i]);
+        vehicle.fuelLevel = static_cast<int>(chunk.fuelLevel[i]);
+        vehicle.enginetemperature = static_cast<int>(chunk.enginetemperature[i]);
+        return vehicle;
+    }
+};
+
+// `prgm2 --fleet=N`: simulate N vehicles for 100 steps and print a summary
+void runFleetSimulation(size_t vehicles)
+{
+    FleetSimulation fleet(vehicles);
+    auto start = chrono::steady_clock::now();
+    fleet.run(100);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "fleet: " << fleet.size() << " vehicles, " << fleet.steps() << " steps of "
+         << FleetSimulation::TIMESTEP_SECONDS << " s on " << fleet.threads() << " threads" << endl;
+    cout << "vehicle updates/s: " << (seconds > 0 ? fleet.size() * fleet.steps() / seconds : 0.0) << endl;
+    cout << "overheat warnings: " << fleet.warnings().overheatRaised.load() << " raised, "
+         << fleet.warnings().overheatActive.load() << " active" << endl;
+    cout << "low fuel warnings: " << fleet.warnings().lowFuelRaised.load() << " raised, "
+         << fleet.warnings().lowFuelActive.load() << " active" << endl;
+    cout << "chunks stolen: " << fleet.stolenChunks() << endl;
+    if (fleet.size() > 0)
+    {
+        cout << "vehicle 0:" << endl;
+        Display().showVehicleData(fleet.vehicle(0));
+    }
+}
+
+#ifdef HMI_HAS_SHARED_MEMORY
+/*Shared-memory telemetry bus
+A writer process (the simulator) publishes VehicleData into a POSIX shared
+memory segment; any number of reader processes (cluster displays) map the
+same segment. The latest sample is guarded by a seqlock and the most recent
+samples are kept in a ring, each slot with its own seqlock. Publishing and
+reading are plain atomic loads/stores: no copies through the kernel and no
+syscalls once the segment is mapped.*/
+
+const char* const TELEMETRY_SEGMENT_NAME = "/prgm2_telemetry";
+const uint32_t TELEMETRY_MAGIC = 0x544C4D31;  // "TLM1", bump on layout change
+const size_t TELEMETRY_RING_CAPACITY = 256;
+const int TELEMETRY_READ_RETRIES = 1000;     // a writer that died mid-write leaves the seqlock odd
+
+// One telemetry sample as seen by readers
+struct TelemetrySample
+{
+    int speed;
+    int fuelLevel;
+    int enginetemperature;
+    uint64_t timestampNs;   // steady clock of the writer
+    uint64_t number;        // 1 for the first published sample
+};
+
+// Seqlock-protected sample slot in shared memory. sequence is odd while the
+// writer is updating the slot and 2 * number once sample `number` is complete.
+struct SharedSlot
+{
+    atomic<uint64_t> sequence;
+    atomic<int32_t> speed;
+    atomic<int32_t> fuelLevel;
+    atomic<int32_t> enginetemperature;
+    atomic<uint64_t> timestampNs;
+
+    void write(const TelemetrySample& sample)
+    {
+        sequence.store(2 * sample.number - 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        speed.store(sample.speed, memory_order_relaxed);
+        fuelLevel.store(sample.fuelLevel, memory_order_relaxed);
+        enginetemperature.store(sample.enginetemperature, memory_order_relaxed);
+        timestampNs.store(sample.timestampNs, memory_order_relaxed);
+        sequence.store(2 * sample.number, memory_order_release);
+    }
+
+    // False if the slot is empty or was being rewritten while we copied it
+    bool read(TelemetrySample& sample) const
+    {
+        uint64_t before = sequence.load(memory_order_acquire);
+        if (before == 0 || before % 2 == 1)
+        {
+            return false;
+        }
+        sample.speed = speed.load(memory_order_relaxed);
+        sample.fuelLevel = fuelLevel.load(memory_order_relaxed);
+        sample.enginetemperature = enginetemperature.load(memory_order_relaxed);
+        sample.timestampNs = timestampNs.load(memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (sequence.load(memory_order_relaxed) != before)
+        {
+            return false;
+        }
+        sample.number = before / 2;
+        return true;
+    }
+};
+
+struct TelemetrySegment
+{
+    uint32_t magic;
+    atomic<uint64_t> published;  // samples written so far
+    SharedSlot latest;
+    SharedSlot ring[TELEMETRY_RING_CAPACITY];
+};
+
+static_assert(atomic<uint64_t>::is_always_lock_free && atomic<int32_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free to work across processes");
+
+class TelemetryBus
+{
+    TelemetrySegment* segment = nullptr;
+    string name;
+    bool writer;
+
+public:
+    enum Role { Writer, Reader };
+
+    // The writer creates (or reuses) the segment and removes its name when it
+    // is destroyed; readers attach to an existing one
+    TelemetryBus(const string& name, Role role) : name(name), writer(role == Writer)
+    {
+        int fd = shm_open(name.c_str(), writer ? O_CREAT | O_RDWR : O_RDONLY, 0644);
+        if (fd < 0)
+        {
+            throw runtime_error("cannot open telemetry segment " + name);
+        }
+        if (writer && ftruncate(fd, sizeof(TelemetrySegment)) != 0)
+        {
+            close(fd);
+            throw runtime_error("cannot size telemetry segment " + name);
+        }
+        void* mapping = mmap(nullptr, sizeof(TelemetrySegment), writer ? PROT_READ | PROT_WRITE : PROT_READ,
+                             MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            throw runtime_error("cannot map telemetry segment " + name);
+        }
+        segment = static_cast<TelemetrySegment*>(mapping);
+
+        if (writer && segment->magic != TELEMETRY_MAGIC)
+        {
+            // Fresh segment: start the atomics' lifetimes before anyone uses them
+            segment = new (mapping) TelemetrySegment();
+            segment->magic = TELEMETRY_MAGIC;
+        }
+        else if (!writer && segment->magic != TELEMETRY_MAGIC)
+        {
+            munmap(segment, sizeof(TelemetrySegment));
+            throw runtime_error("telemetry segment " + name + " has an unknown layout");
+        }
+    }
+
+    ~TelemetryBus()
+    {
+        munmap(segment, sizeof(TelemetrySegment));
+        if (writer)
+        {
+            remove(name);
+        }
+    }
+
+    TelemetryBus(const TelemetryBus&) = delete;
+    TelemetryBus& operator=(const TelemetryBus&) = delete;
+
+    // Remove the segment name; mapped processes keep their mapping
+    static void remove(const string& name)
+    {
+        shm_unlink(name.c_str());
+    }
+
+    uint64_t publish(const VehicleData& vehicle)
+    {
+        TelemetrySample sample;
+        sample.speed = vehicle.speed;
+        sample.fuelLevel = vehicle.fuelLevel;
+        sample.enginetemperature = vehicle.enginetemperature;
+        sample.timestampNs = static_cast<uint64_t>(
+            chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+        sample.number = segment->published.load(memory_order_relaxed) + 1;
+
+        segment->ring[(sample.number - 1) % TELEMETRY_RING_CAPACITY].write(sample);
+        segment->latest.write(sample);
+        segment->published.store(sample.number, memory_order_release);
+        return sample.number;
+    }
+
+    // Most recent sample; false if nothing has been published yet or the
+    // writer kept the slot busy for TELEMETRY_READ_RETRIES attempts
+    bool readLatest(TelemetrySample& sample) const
+    {
+        if (segment->published.load(memory_order_acquire) == 0)
+        {
+            return false;
+        }
+        for (int attempt = 0; attempt < TELEMETRY_READ_RETRIES; attempt++)
+        {
+            if (segment->latest.read(sample))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Up to `count` most recent samples, oldest first
+    vector<TelemetrySample> readRecent(size_t count) const
+    {
+        uint64_t published = segment->published.load(memory_order_acquire);
+        uint64_t first = published > count ? published - count + 1 : 1;
+        if (published >= TELEMETRY_RING_CAPACITY && first <= published - TELEMETRY_RING_CAPACITY)
+        {
+            first = published - TELEMETRY_RING_CAPACITY + 1;
+        }
+        vector<TelemetrySample> samples;
+        for (uint64_t number = first; number <= published; number++)
+        {
+            TelemetrySample sample;
+            // Skip slots the writer has already overwritten with newer samples
+            if (segment->ring[(number - 1) % TELEMETRY_RING_CAPACITY].read(sample) && sample.number == number)
+            {
+                samples.push_back(sample);
+            }
+        }
+        return samples;
+    }
+};
+
+VehicleData toVehicleData(const TelemetrySample& sample)
+{
+    VehicleData vehicle;
+    vehicle.speed = sample.speed;
+    vehicle.fuelLevel = sample.fuelLevel;
+    vehicle.enginetemperature = sample.enginetemperature;
+    return vehicle;
+}
+
+volatile sig_atomic_t telemetryStopRequested = 0;
+
+void requestTelemetryStop(int)
+{
+    telemetryStopRequested = 1;
+}
+
+// Simulator process: update and publish every 3 seconds until interrupted,
+// then remove the segment on the way out
+void runTelemetryWriter()
+{
+    signal(SIGINT, requestTelemetryStop);
+    signal(SIGTERM, requestTelemetryStop);
+    TelemetryBus bus(TELEMETRY_SEGMENT_NAME, TelemetryBus::Writer);
+    VehicleData vehicle;
+    while (!telemetryStopRequested)
+    {
+        vehicle.updatevehicleData();
+        cout << "published sample " << bus.publish(vehicle) << endl;
+        this_thread::sleep_for(chrono::seconds(3));
+    }
+}
+
+// Display process: show each new sample as it appears
+void runTelemetryReader()
 {
+    TelemetryBus bus(TELEMETRY_SEGMENT_NAME, TelemetryBus::Reader);
+    Display display;
+    uint64_t lastShown = 0;
+    while (true)
+    {
+        TelemetrySample sample;
+        if (bus.readLatest(sample) && sample.number != lastShown)
+        {
+            lastShown = sample.number;
+            display.showVehicleData(toVehicleData(sample));
+        }
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+}
+#endif
+
+#ifndef HMI_NO_MAIN
+int main(int argc, char* argv[])
+{
+    string option = argc > 1 ? argv[1] : "";
+    if (option.rfind("--fleet=", 0) == 0)
+    {
+        runFleetSimulation(static_cast<size_t>(strtoull(option.c_str() + 8, nullptr, 10)));
+        return 0;
+    }
+
+#ifdef HMI_HAS_SHARED_MEMORY
+    // Separate processes: `prgm2 --writer` and one or more `prgm2 --reader`
+    string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--writer")
+    {
+        runTelemetryWriter();
+        return 0;
+    }
+    if (mode == "--reader")
+    {
+        runTelemetryReader();
+        return 0;
+    }
+#endif
+
    
 VehicleData myCar;
 Display display;
@@ -92,6 +694,7 @@ Display display;
 
     return 0;
 
-} 
+}
+#endif
 
 
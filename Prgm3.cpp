@@ -19,8 +19,28 @@ Example output demonstrating event handling.
 
 #include<iostream>
 #include<queue>
+#include<vector>
+#include<array>
+#include<chrono>
+#include<algorithm>
+#include<cstdint>
 #include<cstdlib>
 #include<ctime>
+#include<memory_resource>
+#include "HMIMemory.h"
+#include "HMIProfiler.h"
+
+// Asynchronous handlers need C++20 coroutines (the CMake build compiles this
+// program as C++20); older standards keep the synchronous loop only
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include<coroutine>
+#include<functional>
+#include<optional>
+#include<thread>
+#define HMI_HAS_COROUTINES 1
+#endif
+#endif
 using namespace std;
 
 enum eventType
@@ -74,12 +94,723 @@ string getSwipeDirection()
     }
 }
 
+// Display an event and perform its action. A degraded event arrived too late
+// for its full action, so only its end state is applied.
+void handleEvent(const Event &currentEvent, bool degraded = false)
+{
+    currentEvent.displayEvent(); 
+    
+    if (currentEvent.type == Tap)
+    {
+        cout << "Action: Displaying Tap at (" << currentEvent.x << ", " << currentEvent.y << ")\n\n";
+    }
+    else if (currentEvent.type == Swipe && degraded)
+    {
+        cout << "Action: Swipe is stale, jumping to its end position without animation.\n\n";
+    }
+    else if (currentEvent.type == Swipe)
+    {
+        string direction = getSwipeDirection(); 
+        cout << "Action: Performing Swipe in " << direction << " direction.\n\n";
+    }
+}
+
+/*Priority scheduling
+Events are not handled strictly in arrival order. Each one is queued in a
+priority class with a deadline; the loop always serves the highest class
+first and, within a class, the earliest deadline. When the loop falls behind,
+a stale event is handled by its class policy: delivered anyway (safety-relevant
+taps), delivered in a cheaper degraded form, or dropped. Each class also has a
+queue limit, and its queueing delay is recorded for the report.*/
+
+using eventClock = chrono::steady_clock;
+
+enum eventPriority
+{
+    High,
+    Normal,
+    Low,
+    PRIORITY_COUNT
+};
+
+enum stalePolicy
+{
+    Deliver,
+    Degrade,
+    Drop
+};
+
+struct classPolicy
+{
+    eventClock::duration budget;   // deadline = enqueue time + budget
+    stalePolicy whenStale;
+    size_t maxQueued;              // further events are dropped on arrival
+};
+
+struct scheduledEvent
+{
+    Event event;
+    eventPriority priority;
+    eventClock::time_point enqueued;
+    eventClock::time_point deadline;
+    bool degraded;
+    uint64_t sequence = 0;   // push order, FIFO among equal deadlines
+};
+
+struct classStats
+{
+    size_t delivered = 0;   // including degraded and late ones
+    size_t degraded = 0;
+    size_t late = 0;        // delivered after the deadline
+    size_t dropped = 0;
+
+    // Queueing delays are counted in log-linear buckets: 16 per power of two,
+    // so a percentile is within 1/16 of the true delay and the memory stays
+    // fixed however long the loop runs
+    static const unsigned SUB_BUCKET_BITS = 4;
+    static const size_t DELAY_BUCKETS = (64 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+    array<uint64_t, DELAY_BUCKETS> delayCounts{};
+    uint64_t delaySamples = 0;
+    uint64_t maxDelayNs = 0;
+
+    void recordDelay(uint64_t ns)
+    {
+        delayCounts[delayBucket(ns)]++;
+        delaySamples++;
+        maxDelayNs = max(maxDelayNs, ns);
+    }
+
+    // Nearest-rank percentile of the queueing delay, rounded up to its
+    // bucket's upper bound (p100 is exact)
+    uint64_t delayPercentileNs(unsigned p) const
+    {
+        if (delaySamples == 0)
+            return 0;
+        uint64_t rank = max<uint64_t>((delaySamples * p + 99) / 100, 1);
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < DELAY_BUCKETS; bucket++)
+        {
+            seen += delayCounts[bucket];
+            if (seen >= rank)
+                return min(bucketUpperNs(bucket), maxDelayNs);
+        }
+        return maxDelayNs;
+    }
+
+private:
+    static unsigned floorLog2(uint64_t value)
+    {
+        unsigned log = 0;
+        for (unsigned step = 32; step > 0; step /= 2)
+        {
+            if (value >> step)
+            {
+                value >>= step;
+                log += step;
+            }
+        }
+        return log;
+    }
+
+    // Values below 16 get a bucket each; above that, the top 4 bits after the
+    // leading one select one of 16 buckets within the power of two
+    static size_t delayBucket(uint64_t ns)
+    {
+        if (ns < (uint64_t(1) << SUB_BUCKET_BITS))
+            return static_cast<size_t>(ns);
+        unsigned exponent = floorLog2(ns);
+        unsigned shift = exponent - SUB_BUCKET_BITS;
+        size_t sub = static_cast<size_t>(ns >> shift) & ((size_t(1) << SUB_BUCKET_BITS) - 1);
+        return (size_t(shift + 1) << SUB_BUCKET_BITS) + sub;
+    }
+
+    static uint64_t bucketUpperNs(size_t bucket)
+    {
+        if (bucket < (size_t(1) << SUB_BUCKET_BITS))
+            return bucket;
+        unsigned shift = static_cast<unsigned>(bucket >> SUB_BUCKET_BITS) - 1;
+        uint64_t sub = bucket & ((size_t(1) << SUB_BUCKET_BITS) - 1);
+        uint64_t lower = ((uint64_t(1) << SUB_BUCKET_BITS) + sub) << shift;
+        return lower + ((uint64_t(1) << shift) - 1);
+    }
+};
+
+// Taps can be safety-relevant, swipes are not
+eventPriority defaultPriority(eventType type)
+{
+    return type == Tap ? High : Normal;
+}
+
+const char *priorityName(eventPriority priority)
+{
+    switch (priority)
+    {
+        case High: return "high";
+        case Normal: return "normal";
+        default: return "low";
+    }
+}
+
+class EventScheduler
+{
+    struct laterDeadline
+    {
+        bool operator()(const scheduledEvent &a, const scheduledEvent &b) const
+        {
+            return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+        }
+    };
+
+    struct eventClass
+    {
+        classPolicy policy;
+        priority_queue<scheduledEvent, pmr::vector<scheduledEvent>, laterDeadline> pending;
+        classStats stats;
+
+        explicit eventClass(pmr::memory_resource *resource)
+            : pending(laterDeadline(), pmr::vector<scheduledEvent>(resource))
+        {}
+    };
+
+    array<eventClass, PRIORITY_COUNT> classes;
+    uint64_t nextSequence = 0;
+
+public:
+    // Queue storage comes from `resource`, e.g. a tracked pool
+    explicit EventScheduler(pmr::memory_resource *resource = pmr::get_default_resource())
+        : classes{eventClass(resource), eventClass(resource), eventClass(resource)}
+    {
+        classes[High].policy = {chrono::milliseconds(20), Deliver, SIZE_MAX};
+        classes[Normal].policy = {chrono::milliseconds(50), Degrade, 4096};
+        classes[Low].policy = {chrono::milliseconds(100), Drop, 1024};
+    }
+
+    void setPolicy(eventPriority priority, const classPolicy &policy)
+    {
+        classes[priority].policy = policy;
+    }
+
+    // Returns false if the class queue is full and the event was dropped
+    bool push(const Event &event, eventPriority priority, eventClock::time_point now)
+    {
+        eventClass &target = classes[priority];
+        if (target.pending.size() >= target.policy.maxQueued)
+        {
+            target.stats.dropped++;
+            return false;
+        }
+        target.pending.push({event, priority, now, now + target.policy.budget, false, nextSequence++});
+        return true;
+    }
+
+    bool push(const Event &event, eventClock::time_point now)
+    {
+        return push(event, defaultPriority(event.type), now);
+    }
+
+    // Next event to handle at time `now`; false when nothing is pending
+    bool pop(scheduledEvent &next, eventClock::time_point now)
+    {
+        for (eventClass &current : classes)
+        {
+            // Stale events of a dropping class are discarded without being handled
+            while (current.policy.whenStale == Drop && !current.pending.empty() && current.pending.top().deadline < now)
+            {
+                current.pending.pop();
+                current.stats.dropped++;
+            }
+            if (current.pending.empty())
+                continue;
+
+            next = current.pending.top();
+            current.pending.pop();
+            current.stats.delivered++;
+            current.stats.recordDelay(static_cast<uint64_t>(
+                chrono::duration_cast<chrono::nanoseconds>(now - next.enqueued).count()));
+            if (next.deadline < now)
+            {
+                current.stats.late++;
+                if (current.policy.whenStale == Degrade)
+                {
+                    next.degraded = true;
+                    current.stats.degraded++;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+    size_t size() const
+    {
+        size_t total = 0;
+        for (const eventClass &current : classes)
+            total += current.pending.size();
+        return total;
+    }
+
+    const classStats &stats(eventPriority priority) const
+    {
+        return classes[priority].stats;
+    }
+
+    // Per-class counts and queueing delay (microseconds)
+    void report(ostream &out) const
+    {
+        out << "---- event scheduler ----" << endl;
+        for (int p = 0; p < PRIORITY_COUNT; p++)
+        {
+            const classStats &current = classes[p].stats;
+            out << priorityName(static_cast<eventPriority>(p)) << ": delivered " << current.delivered
+                << ", degraded " << current.degraded << ", late " << current.late << ", dropped " << current.dropped
+                << " | delay p50/p99/max " << current.delayPercentileNs(50) / 1000.0 << " / "
+                << current.delayPercentileNs(99) / 1000.0 << " / " << current.delayPercentileNs(100) / 1000.0
+                << " us" << endl;
+        }
+    }
+};
+
+#ifdef HMI_HAS_COROUTINES
+/*Asynchronous handlers
+A handler that waits (an animation, a long press, a confirmation) is written
+as a coroutine and co_awaits a timer or the next event of some type instead of
+blocking the loop. Every coroutine runs on the single thread that calls
+EventLoop::run(), so thousands of in-flight interactions need no extra threads.
+Coroutine frames come from a pool of size-class free lists, and waiting for a
+timer or an event uses nodes inside the awaiting frame, so once the pool is
+warm an await allocates nothing.*/
+
+// Recycles coroutine frames; only used from the loop thread, so no locking
+class framePool
+{
+    static constexpr size_t GRANULE = 64;
+    static constexpr size_t CLASSES = 16;   // frames up to 1 KiB are pooled
+
+    struct freeFrame
+    {
+        freeFrame *next;
+    };
+
+    array<freeFrame*, CLASSES> freeLists{};
+    size_t heapAllocations = 0;
+    size_t reuses = 0;
+    size_t liveFrames = 0;
+
+    framePool() = default;
+
+public:
+    static framePool &instance()
+    {
+        static framePool pool;
+        return pool;
+    }
+
+    ~framePool()
+    {
+        for (freeFrame *head : freeLists)
+        {
+            while (head)
+            {
+                freeFrame *next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+
+    void *allocate(size_t size)
+    {
+        liveFrames++;
+        size_t sizeClass = (size + GRANULE - 1) / GRANULE;
+        if (sizeClass > CLASSES)
+        {
+            heapAllocations++;
+            return ::operator new(size);
+        }
+        freeFrame *&head = freeLists[sizeClass - 1];
+        if (head)
+        {
+            freeFrame *frame = head;
+            head = frame->next;
+            reuses++;
+            return frame;
+        }
+        heapAllocations++;
+        return ::operator new(sizeClass * GRANULE);
+    }
+
+    void release(void *frame, size_t size)
+    {
+        liveFrames--;
+        size_t sizeClass = (size + GRANULE - 1) / GRANULE;
+        if (sizeClass > CLASSES)
+        {
+            ::operator delete(frame);
+            return;
+        }
+        freeFrame *node = static_cast<freeFrame*>(frame);
+        node->next = freeLists[sizeClass - 1];
+        freeLists[sizeClass - 1] = node;
+    }
+
+    size_t heapCount() const { return heapAllocations; }
+    size_t reuseCount() const { return reuses; }
+    size_t live() const { return liveFrames; }   // coroutines still in flight
+};
+
+// Fire-and-forget coroutine handler. It starts suspended and runs once it is
+// handed to EventLoop::spawn(); its frame is freed when it finishes.
+struct handlerTask
+{
+    struct promise_type
+    {
+        handlerTask get_return_object() { return {coroutine_handle<promise_type>::from_promise(*this)}; }
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+
+        static void *operator new(size_t size) { return framePool::instance().allocate(size); }
+        static void operator delete(void *frame, size_t size) { framePool::instance().release(frame, size); }
+    };
+
+    coroutine_handle<promise_type> handle;
+};
+
+// A coroutine waiting for the next event of one type; lives in its frame
+struct eventWaiter
+{
+    eventWaiter *prev = nullptr;
+    eventWaiter *next = nullptr;
+    coroutine_handle<> handle;
+    eventType type = Tap;
+    optional<Event> result;
+    size_t timerSlot = SIZE_MAX;   // timeout timer, if any
+};
+
+class EventLoop
+{
+    struct timerSlot
+    {
+        coroutine_handle<> handle;
+        eventWaiter *waiter;   // set for event timeouts
+        bool live;
+    };
+
+    struct timerEntry
+    {
+        eventClock::time_point due;
+        uint64_t sequence;     // FIFO among timers due at the same time
+        size_t slot;
+    };
+
+    struct laterTimer
+    {
+        bool operator()(const timerEntry &a, const timerEntry &b) const
+        {
+            return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+        }
+    };
+
+    EventScheduler scheduler;
+    function<handlerTask(EventLoop&, const Event&, bool)> handlerFactory;
+    vector<coroutine_handle<>> ready;
+    vector<coroutine_handle<>> running;
+    vector<timerEntry> timers;             // heap ordered by laterTimer
+    vector<timerSlot> slots;
+    vector<size_t> freeSlots;
+    array<eventWaiter*, 2> waitersHead{};  // per eventType, oldest first
+    array<eventWaiter*, 2> waitersTail{};
+    uint64_t timerSequence = 0;
+    bool virtualTime;
+    eventClock::time_point virtualNow{};
+
+    void resumeReady()
+    {
+        while (!ready.empty())
+        {
+            running.swap(ready);
+            for (coroutine_handle<> handle : running)
+            {
+                handle.resume();
+            }
+            running.clear();
+        }
+    }
+
+    void unlinkWaiter(eventType type, eventWaiter &waiter)
+    {
+        (waiter.prev ? waiter.prev->next : waitersHead[type]) = waiter.next;
+        (waiter.next ? waiter.next->prev : waitersTail[type]) = waiter.prev;
+        waiter.prev = waiter.next = nullptr;
+    }
+
+    // An event goes to the oldest coroutine waiting for its type, otherwise
+    // to a new handler
+    void dispatch(const scheduledEvent &next)
+    {
+        eventType type = next.event.type;
+        if (eventWaiter *waiter = waitersHead[type])
+        {
+            unlinkWaiter(type, *waiter);
+            waiter->result = next.event;
+            if (waiter->timerSlot != SIZE_MAX)
+            {
+                slots[waiter->timerSlot].live = false;
+            }
+            ready.push_back(waiter->handle);
+        }
+        else if (handlerFactory)
+        {
+            spawn(handlerFactory(*this, next.event, next.degraded));
+        }
+    }
+
+    // Timeouts whose event arrived first stay in the heap; drop them once they
+    // reach the top so run() never waits for a deadline nobody is waiting on
+    void dropCancelledTimers()
+    {
+        while (!timers.empty() && !slots[timers.front().slot].live)
+        {
+            pop_heap(timers.begin(), timers.end(), laterTimer());
+            freeSlots.push_back(timers.back().slot);
+            timers.pop_back();
+        }
+    }
+
+    void fireDueTimers()
+    {
+        while (!timers.empty() && timers.front().due <= now())
+        {
+            pop_heap(timers.begin(), timers.end(), laterTimer());
+            timerSlot &slot = slots[timers.back().slot];
+            freeSlots.push_back(timers.back().slot);
+            timers.pop_back();
+            if (!slot.live)
+            {
+                continue;   // the event arrived first
+            }
+            slot.live = false;
+            if (slot.waiter)
+            {
+                unlinkWaiter(slot.waiter->type, *slot.waiter);
+            }
+            ready.push_back(slot.handle);
+        }
+    }
+
+public:
+    struct sleepAwaiter
+    {
+        EventLoop &loop;
+        eventClock::duration delay;
+
+        bool await_ready() const noexcept { return delay <= eventClock::duration::zero(); }
+        void await_suspend(coroutine_handle<> handle) { loop.addTimer(delay, handle, nullptr); }
+        void await_resume() const noexcept {}
+    };
+
+    struct eventAwaiter
+    {
+        EventLoop &loop;
+        eventType type;
+        eventClock::duration timeout;   // max(): wait forever
+        eventWaiter waiter;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(coroutine_handle<> handle)
+        {
+            waiter.handle = handle;
+            loop.addWaiter(type, waiter);
+            if (timeout != eventClock::duration::max())
+            {
+                waiter.timerSlot = loop.addTimer(timeout, handle, &waiter);
+            }
+        }
+        // Empty if the timeout expired first
+        optional<Event> await_resume() { return move(waiter.result); }
+    };
+
+    // With virtualTime, timers complete instantly in due order (demos, benchmarks)
+    explicit EventLoop(bool virtualTime = false) : virtualTime(virtualTime) {}
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop &operator=(const EventLoop&) = delete;
+
+    // Destroys coroutines that are still suspended
+    ~EventLoop()
+    {
+        for (coroutine_handle<> handle : ready)
+        {
+            handle.destroy();
+        }
+        for (timerSlot &slot : slots)
+        {
+            if (slot.live && !slot.waiter)
+            {
+                slot.handle.destroy();
+            }
+        }
+        for (eventWaiter *head : waitersHead)
+        {
+            while (head)
+            {
+                eventWaiter *next = head->next;
+                head->handle.destroy();
+                head = next;
+            }
+        }
+    }
+
+    eventClock::time_point now() const
+    {
+        return virtualTime ? virtualNow : eventClock::now();
+    }
+
+    // Called for every event no coroutine is waiting for
+    void onEvent(function<handlerTask(EventLoop&, const Event&, bool)> factory)
+    {
+        handlerFactory = move(factory);
+    }
+
+    void spawn(handlerTask task)
+    {
+        ready.push_back(task.handle);
+    }
+
+    void post(const Event &event)
+    {
+        scheduler.push(event, now());
+    }
+
+    void post(const Event &event, eventPriority priority)
+    {
+        scheduler.push(event, priority, now());
+    }
+
+    sleepAwaiter sleep(eventClock::duration delay)
+    {
+        return {*this, delay};
+    }
+
+    eventAwaiter nextEvent(eventType type, eventClock::duration timeout = eventClock::duration::max())
+    {
+        return {*this, type, timeout, {}};
+    }
+
+    size_t addTimer(eventClock::duration delay, coroutine_handle<> handle, eventWaiter *waiter)
+    {
+        size_t slot;
+        if (freeSlots.empty())
+        {
+            slot = slots.size();
+            slots.push_back({});
+        }
+        else
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        slots[slot] = {handle, waiter, true};
+        timers.push_back({now() + delay, timerSequence++, slot});
+        push_heap(timers.begin(), timers.end(), laterTimer());
+        return slot;
+    }
+
+    void addWaiter(eventType type, eventWaiter &waiter)
+    {
+        waiter.type = type;
+        waiter.prev = waitersTail[type];
+        waiter.next = nullptr;
+        (waitersTail[type] ? waitersTail[type]->next : waitersHead[type]) = &waiter;
+        waitersTail[type] = &waiter;
+    }
+
+    // Runs until no coroutine is ready or sleeping and no event is queued
+    void run()
+    {
+        scheduledEvent next{Event(Tap, 0, 0, ""), High, {}, {}, false};
+        while (true)
+        {
+            resumeReady();
+            while (scheduler.pop(next, now()))
+            {
+                HMI_PROFILE_SCOPE("eventLoop/dispatch");
+                dispatch(next);
+                resumeReady();
+            }
+            dropCancelledTimers();
+            if (timers.empty())
+            {
+                break;
+            }
+            if (virtualTime)
+            {
+                virtualNow = max(virtualNow, timers.front().due);
+            }
+            else
+            {
+                this_thread::sleep_until(timers.front().due);
+            }
+            fireDueTimers();
+        }
+    }
+
+    const EventScheduler &eventScheduler() const { return scheduler; }
+};
+
+// Coroutine version of handleEvent: taps in the top-left corner ask for a
+// confirming tap, swipes animate over several frames
+handlerTask handleEventAsync(EventLoop &loop, Event event, bool degraded)
+{
+    event.displayEvent();
+    if (event.type == Tap && event.x < 100 && event.y < 100)
+    {
+        cout << "Action: Delete requested, tap again within 2 s to confirm\n\n";
+        optional<Event> reply = co_await loop.nextEvent(Tap, chrono::seconds(2));
+        cout << (reply ? "Action: Delete confirmed\n\n" : "Action: Delete cancelled (no confirmation)\n\n");
+    }
+    else if (event.type == Tap)
+    {
+        co_await loop.sleep(chrono::milliseconds(100));   // press animation
+        cout << "Action: Displaying Tap at (" << event.x << ", " << event.y << ")\n\n";
+    }
+    else if (degraded)
+    {
+        cout << "Action: Swipe is stale, jumping to its end position without animation.\n\n";
+    }
+    else
+    {
+        string direction = getSwipeDirection();
+        for (int frame = 1; frame <= 4; frame++)
+        {
+            co_await loop.sleep(chrono::milliseconds(16));
+            cout << "Action: Swipe " << direction << " frame " << frame << "/4\n";
+        }
+        cout << endl;
+    }
+}
+
+// Simulated touchscreen: random events at random intervals
+handlerTask touchInput(EventLoop &loop, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        co_await loop.sleep(chrono::milliseconds(rand() % 300));
+        loop.post(Event(getRandomEventType(), rand() % 500, rand() % 500, getRandomTimestamp()));
+    }
+}
+#endif
+
+#ifndef HMI_NO_MAIN
 int main()
 {
   
     srand(time(0));
     
-    queue<Event> eventQueue;
+    // queued events live in the "events" pool
+    hmimem::Pool eventPool("events");
+    EventScheduler scheduler(&eventPool);
     
    
     for (int i = 0; i < 5; ++i)
@@ -92,29 +823,35 @@ int main()
         
         
         Event newEvent(type, x, y, timestamp);
-        eventQueue.push(newEvent);
+        scheduler.push(newEvent, eventClock::now());
     }
     
    
-    while (!eventQueue.empty())
+    scheduledEvent currentEvent{Event(Tap, 0, 0, ""), High, {}, {}, false};
+    while (scheduler.pop(currentEvent, eventClock::now()))
     {
-        Event currentEvent = eventQueue.front(); 
-        eventQueue.pop(); 
-        
-        currentEvent.displayEvent(); 
-        
-        
-        if (currentEvent.type == Tap)
-        {
-            cout << "Action: Displaying Tap at (" << currentEvent.x << ", " << currentEvent.y << ")\n\n";
-        }
-        else if (currentEvent.type == Swipe)
-        {
-            string direction = getSwipeDirection(); 
-            cout << "Action: Performing Swipe in " << direction << " direction.\n\n";
-        }
+        HMI_PROFILE_SCOPE("eventLoop/processEvent");
+        handleEvent(currentEvent.event, currentEvent.degraded);
+    }
+    scheduler.report(cout);
+
+#ifdef HMI_HAS_COROUTINES
+    // The same kind of input handled by coroutines that wait without blocking
+    cout << "\n---- asynchronous handlers ----\n" << endl;
+    {
+        EventLoop loop;
+        loop.onEvent(handleEventAsync);
+        loop.spawn(touchInput(loop, 10));
+        loop.run();
+        loop.eventScheduler().report(cout);
     }
+    cout << "coroutine frames: " << framePool::instance().heapCount() << " allocated, "
+         << framePool::instance().reuseCount() << " reused" << endl;
+#endif
     
+    hmimem::report(cout);
+    HMI_PROFILE_REPORT("prgm3_trace.json");
     return 0;
 }
+#endif
 
@@ -24,8 +24,91 @@ Include a README file with instructions for running the program.*/
 #include <iostream>
 #include <thread>
 #include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "HMIMemory.h"
+#include "HMIProfiler.h"
+#include "HeadlessDriver.h"
 using namespace std;
  
+/// @brief storage for the formatted theme strings
+// Append-only character blocks shared by all themes. Each formatted string
+// is stored once and handed out as a string_view, so showing it again costs
+// no allocation. When more than half of the stored bytes belong to strings
+// that were invalidated, the arena is reset and its epoch changes; themes
+// notice the new epoch and format again. Views are valid until the next
+// setter call on any theme. Themes are used from the UI thread only; each
+// one holds a reference to the arena, so it outlives every theme, static
+// ones included.
+class FormatArena
+{
+    static const size_t BLOCK_SIZE = 4096;
+ 
+    vector<unique_ptr<char[]>> blocks;
+    size_t blockUsed = BLOCK_SIZE;
+    size_t liveBytes = 0;
+    size_t staleBytes = 0;
+    uint64_t epoch = 1;
+ 
+public:
+    static const shared_ptr<FormatArena> &shared()
+    {
+        static const shared_ptr<FormatArena> arena = make_shared<FormatArena>();
+        return arena;
+    }
+ 
+    string_view store(string_view text)
+    {
+        if (text.size() > BLOCK_SIZE)
+        {
+            // oversized strings get their own block, kept in front of the current one
+            unique_ptr<char[]> block(new char[text.size()]);
+            char *target = block.get();
+            blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, move(block));
+            text.copy(target, text.size());
+            liveBytes += text.size();
+            return string_view(target, text.size());
+        }
+        if (blockUsed + text.size() > BLOCK_SIZE)
+        {
+            blocks.emplace_back(new char[BLOCK_SIZE]);
+            blockUsed = 0;
+        }
+        char *target = blocks.back().get() + blockUsed;
+        text.copy(target, text.size());
+        blockUsed += text.size();
+        liveBytes += text.size();
+        return string_view(target, text.size());
+    }
+ 
+    // Marks `bytes` of stored text as no longer used
+    void release(size_t bytes)
+    {
+        liveBytes -= bytes;
+        staleBytes += bytes;
+        if (staleBytes > liveBytes && staleBytes > BLOCK_SIZE)
+        {
+            blocks.clear();
+            blockUsed = BLOCK_SIZE;
+            liveBytes = staleBytes = 0;
+            epoch++;
+        }
+    }
+ 
+    uint64_t currentEpoch() const { return epoch; }
+    size_t bytesInUse() const { return liveBytes; }
+};
+ 
+// Per-widget labels of one theme, as drawn every frame
+struct ThemeLabels
+{
+    string_view background;   // "Red-Background"
+    string_view font;         // "White-Font"
+    string_view size;         // "14-px"
+    string_view icon;         // "Minimal-Style"
+};
+ 
 /// @brief theme class
  
 class Theme
@@ -35,30 +118,109 @@ class Theme
     int fontSize;
     string iconStyle;
  
+    // formatted strings in `arena`; valid while cachedEpoch matches
+    shared_ptr<FormatArena> arena = FormatArena::shared();
+    mutable uint64_t cachedEpoch = 0;
+    mutable size_t cachedBytes = 0;
+    mutable string_view cachedPreview;
+    mutable ThemeLabels cachedLabels;
+ 
+    // called by every setter
+    void invalidate()
+    {
+        if (cachedEpoch == arena->currentEpoch())
+        {
+            arena->release(cachedBytes);
+        }
+        cachedEpoch = 0;
+    }
+ 
+    void format() const
+    {
+        FormatArena &arena = *this->arena;
+        if (cachedEpoch == arena.currentEpoch())
+        {
+            return;
+        }
+        cachedLabels.background = arena.store(backgroundColor + "-Background");
+        cachedLabels.font = arena.store(fontColor + "-Font");
+        cachedLabels.size = arena.store(to_string(fontSize) + "-px");
+        cachedLabels.icon = arena.store(iconStyle + "-Style");
+        string preview = previewPrefix();
+        for (string_view label : {cachedLabels.background, cachedLabels.font, cachedLabels.size, cachedLabels.icon})
+        {
+            preview.append(label.data(), label.size()).append(", ");
+        }
+        preview.resize(preview.size() - 2);
+        cachedPreview = arena.store(preview);
+        cachedBytes = cachedLabels.background.size() + cachedLabels.font.size() + cachedLabels.size.size() +
+                      cachedLabels.icon.size() + cachedPreview.size();
+        cachedEpoch = arena.currentEpoch();
+    }
+ 
+protected:
+    // text in front of the preview line, e.g. "SportTheme, "
+    virtual string previewPrefix() const { return ""; }
+ 
 public:
     Theme(string backgroundColor, string fontColor, int fontSize, string iconStyle) : backgroundColor(backgroundColor), fontColor(fontColor), fontSize(fontSize), iconStyle(iconStyle) 
     {}
  
+    // a copy has the same settings but formats its own strings, so the two
+    // never release the same bytes
+    Theme(const Theme &other)
+        : backgroundColor(other.backgroundColor), fontColor(other.fontColor), fontSize(other.fontSize),
+          iconStyle(other.iconStyle), arena(other.arena)
+    {}
+ 
+    Theme &operator=(const Theme &other)
+    {
+        if (this != &other)
+        {
+            invalidate();
+            backgroundColor = other.backgroundColor;
+            fontColor = other.fontColor;
+            fontSize = other.fontSize;
+            iconStyle = other.iconStyle;
+        }
+        return *this;
+    }
+ 
+    virtual ~Theme() { invalidate(); }
+ 
     // setters
-    void setBackgroundColor(string backgroundColor) { this->backgroundColor = backgroundColor; }
+    void setBackgroundColor(string backgroundColor) { this->backgroundColor = backgroundColor; invalidate(); }
  
-    void setFontColor(string fontColor) { this->fontColor = fontColor; }
+    void setFontColor(string fontColor) { this->fontColor = fontColor; invalidate(); }
  
-    void setFontSize(int fontSize) { this->fontSize = fontSize; }
+    void setFontSize(int fontSize) { this->fontSize = fontSize; invalidate(); }
  
-    void setIconStyle(string iconStyle) { this->iconStyle = iconStyle; }
+    void setIconStyle(string iconStyle) { this->iconStyle = iconStyle; invalidate(); }
  
     // getters
-    string getBackgroundColor() { return backgroundColor; }
-    string getFontColor() { return fontColor; }
-    int getFontSize() { return fontSize; }
-    string getIconStyle() { return iconStyle; }
+    const string &getBackgroundColor() const { return backgroundColor; }
+    const string &getFontColor() const { return fontColor; }
+    int getFontSize() const { return fontSize; }
+    const string &getIconStyle() const { return iconStyle; }
+ 
+    // formatted once, then reused until a setter changes the theme
+    string_view preview() const
+    {
+        format();
+        return cachedPreview;
+    }
+ 
+    const ThemeLabels &labels() const
+    {
+        format();
+        return cachedLabels;
+    }
  
     // display theme
     virtual void displayTheme()
     {
         cout << "Default theme" << endl;
-        cout << getBackgroundColor() << "-Background, " << getFontColor() << "-Font, " << getFontSize() << "-px, " << getIconStyle() << "-Style" << endl;
+        cout << preview() << endl;
     }
 };
  
@@ -68,14 +230,17 @@ class Classic : public Theme
 {
     string themeType;
  
+protected:
+    string previewPrefix() const override { return themeType + "Theme, "; }
+ 
 public:
     Classic(string themeType, string backgroundColor, string fontColor, int fontSize, string iconStyle) : Theme(backgroundColor, fontColor, fontSize, iconStyle), themeType(themeType) {}
     // display theme overrriden
     void displayTheme()
     {
         cout << "applying theme--" << endl;
-        this_thread::sleep_for(chrono::seconds(2));
-        cout << themeType << "Theme, " << getBackgroundColor() << "-Background, " << getFontColor() << "-Font, " << getFontSize() << "-px, " << getIconStyle() << "-Style" << endl;
+        headless::sleepFor(chrono::seconds(2));
+        cout << preview() << endl;
     }
 };
  
@@ -84,13 +249,16 @@ class Sport : public Theme
 {
     string themeType;
  
+protected:
+    string previewPrefix() const override { return themeType + "Theme, "; }
+ 
 public:
     Sport(string themeType, string backgroundColor, string fontColor, int fontSize, string iconStyle) : Theme(backgroundColor, fontColor, fontSize, iconStyle), themeType(themeType) {}
     void displayTheme()
     {
         cout << "applying theme.." << endl;
-        this_thread::sleep_for(chrono::seconds(2));
-        cout << themeType << "Theme, " << getBackgroundColor() << "-Background, " << getFontColor() << "-Font, " << getFontSize() << "-px, " << getIconStyle() << "-Style" << endl;
+        headless::sleepFor(chrono::seconds(2));
+        cout << preview() << endl;
     }
 };
  
@@ -99,36 +267,57 @@ class Eco : public Theme
 {
     string themeType;
  
+protected:
+    string previewPrefix() const override { return themeType + "Theme, "; }
+ 
 public:
     Eco(string themeType, string backgroundColor, string fontColor, int fontSize, string iconStyle) : Theme(backgroundColor, fontColor, fontSize, iconStyle), themeType(themeType) {}
     void displayTheme()
     {
         cout << "applying theme.." << endl;
-        this_thread::sleep_for(chrono::seconds(2));
-        cout << themeType << "Theme, " << getBackgroundColor() << "-Background, " << getFontColor() << "-Font, " << getFontSize() << "-px, " << getIconStyle() << "-Style" << endl;
+        headless::sleepFor(chrono::seconds(2));
+        cout << preview() << endl;
     }
 };
  
 // switch theme
 void switchTheme(Theme *theme)
 {
+    HMI_PROFILE_SCOPE("switchTheme");
     theme->displayTheme();
 }
  
-int main()
+#ifndef HMI_NO_MAIN
+int main(int argc, char **argv)
 {
+    if (!headless::parseOptions(argc, argv))
+    {
+        return 1;
+    }
+    // headless runs feed theme choices (including invalid ones) instead of reading the console
+    headless::Session session([](mt19937 &random)
+                              { return to_string(uniform_int_distribution<int>(1, 4)(random)); });
+ 
+    // theme objects and the theme map come from the "themes" pool
+    hmimem::Pool themePool("themes");
+ 
     // create Theme object and dispaly current theme
  
-    Theme *theme = new Theme("Red", "White", 10, "Minimal");
+    hmimem::UniquePtr<Theme> defaultTheme = hmimem::makeUnique<Theme>(themePool, "Red", "White", 10, "Minimal");
+    Theme *theme = defaultTheme.get();
     theme->displayTheme();
  
     // create multiple themes
-    Theme *classic = new Classic("Classic", "Red", "White", 14, "Minimal");
-    Theme *sport = new Sport("Sport", "Red", "Black", 16, "Dynamic");
-    Theme *eco = new Eco("Eco", "Green", "White", 15, "Flat");
+    hmimem::UniquePtr<Theme> ownedThemes[] = {
+        hmimem::makeUnique<Classic>(themePool, "Classic", "Red", "White", 14, "Minimal"),
+        hmimem::makeUnique<Sport>(themePool, "Sport", "Red", "Black", 16, "Dynamic"),
+        hmimem::makeUnique<Eco>(themePool, "Eco", "Green", "White", 15, "Flat")};
+    Theme *classic = ownedThemes[0].get();
+    Theme *sport = ownedThemes[1].get();
+    Theme *eco = ownedThemes[2].get();
  
     // store themes in a map [key=themeType, value=theme Objecte]
-    map<string, Theme *> themes;
+    pmr::map<pmr::string, Theme *> themes(&themePool);
     themes.insert({"Classic", classic});
     themes.insert({"Sport", sport});
     themes.insert({"Eco", eco});
@@ -140,16 +329,21 @@ int main()
     while (true)
     {
         count++;
-        if (count == 6)
+        // interactive runs take five choices; headless runs go until the input ends
+        if (count == 6 && !headless::enabled())
         {
             break;
         }
         cout << endl;
         {
-            this_thread::sleep_for(chrono::seconds(2));
+            headless::sleepFor(chrono::seconds(2));
             cout << "Choose Theme:" << endl;
             cout << "1.Classic\n2.Sport\n3.Eco" << endl;
-            cin >> choice;
+            if (!(session.input() >> choice))
+            {
+                break;
+            }
+            session.tick();
             // display the theme based on selected theme
             switch (choice)
             {
@@ -170,16 +364,16 @@ int main()
                 switchTheme(theme);
                 break;
             }
-            this_thread::sleep_for(chrono::seconds(1));
+            headless::sleepFor(chrono::seconds(1));
         }
     }
  
-    delete theme;
-    delete eco;
-    delete classic;
-    delete sport;
+    session.finish();
+    hmimem::report(cout);
  
+    HMI_PROFILE_REPORT("prgm4_trace.json");
     return 0;
-} 
+}
+#endif
 
 
@@ -26,6 +26,10 @@ Print the results of each algorithm in a user-friendly format.*/
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include "ControlSnapshot.h"
  
 using namespace std;
  
@@ -47,8 +51,351 @@ void printControl(const Control& control) {
          << ", Type: " << control.type 
          << ", State: " << control.state << endl;
 }
+
+/*Columnar control store
+Control types and states have only a handful of distinct values and usually
+come in long runs, so ControlStore keeps each field as its own compressed
+column: type and state strings are replaced by small dictionary codes and
+stored run-length encoded, and IDs are stored as runs of consecutive values.
+The queries below work on the runs directly, so their cost depends on the
+number of runs rather than the number of controls.*/
+
+// Distinct strings of one column, each with a small code
+class StringDictionary {
+    vector<string> values;
+
+public:
+    uint16_t intern(const string& value) {
+        uint16_t code;
+        if (find(value, code)) {
+            return code;
+        }
+        if (values.size() > numeric_limits<uint16_t>::max()) {
+            throw runtime_error("too many distinct values in a column");
+        }
+        values.push_back(value);
+        return static_cast<uint16_t>(values.size() - 1);
+    }
+
+    // False if the value never occurs in the column
+    bool find(const string& value, uint16_t& code) const {
+        for (size_t i = 0; i < values.size(); i++) {
+            if (values[i] == value) {
+                code = static_cast<uint16_t>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const string& value(uint16_t code) const { return values[code]; }
+    size_t size() const { return values.size(); }
+
+    size_t memoryBytes() const {
+        size_t bytes = values.capacity() * sizeof(string);
+        for (const string& value : values) {
+            bytes += value.capacity() > 15 ? value.capacity() + 1 : 0;   // beyond the small-string buffer
+        }
+        return bytes;
+    }
+};
+
+// Run-length encoded column of dictionary codes. Adjacent runs always have
+// different codes.
+class RunLengthColumn {
+    vector<uint32_t> runEnds;    // exclusive end position of each run
+    vector<uint16_t> runCodes;
+    vector<size_t> codeCounts;   // total length per code
+
+    size_t runStart(size_t run) const { return run == 0 ? 0 : runEnds[run - 1]; }
+
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    void push_back(uint16_t code) {
+        if (!runCodes.empty() && runCodes.back() == code) {
+            runEnds.back()++;
+        } else {
+            if (size() == numeric_limits<uint32_t>::max()) {
+                throw runtime_error("column is full");
+            }
+            runEnds.push_back(static_cast<uint32_t>(size() + 1));
+            runCodes.push_back(code);
+        }
+        if (codeCounts.size() <= code) {
+            codeCounts.resize(code + 1, 0);
+        }
+        codeCounts[code]++;
+    }
+
+    size_t size() const { return runEnds.empty() ? 0 : runEnds.back(); }
+    size_t runs() const { return runCodes.size(); }
+
+    // Run holding `position` (binary search)
+    size_t runAt(size_t position) const {
+        return upper_bound(runEnds.begin(), runEnds.end(), position) - runEnds.begin();
+    }
+
+    uint16_t at(size_t position) const { return runCodes[runAt(position)]; }
+
+    size_t count(uint16_t code) const { return code < codeCounts.size() ? codeCounts[code] : 0; }
+
+    // First position holding `code`, or npos
+    size_t find(uint16_t code) const {
+        for (size_t run = 0; run < runCodes.size(); run++) {
+            if (runCodes[run] == code) {
+                return runStart(run);
+            }
+        }
+        return npos;
+    }
+
+    // First position whose value equals the next one (like adjacent_find), or npos
+    size_t adjacentRepeat() const {
+        for (size_t run = 0; run < runEnds.size(); run++) {
+            if (runEnds[run] - runStart(run) >= 2) {
+                return runStart(run);
+            }
+        }
+        return npos;
+    }
+
+    // Whether [first1, first1 + length) and [first2, first2 + length) hold the
+    // same codes; steps from run boundary to run boundary
+    bool equal(size_t first1, size_t first2, size_t length) const {
+        if (length == 0) {
+            return true;
+        }
+        size_t run1 = runAt(first1), run2 = runAt(first2);
+        size_t done = 0;
+        while (done < length) {
+            if (runCodes[run1] != runCodes[run2]) {
+                return false;
+            }
+            size_t left1 = runEnds[run1] - (first1 + done);
+            size_t left2 = runEnds[run2] - (first2 + done);
+            done += min(left1, left2);
+            if (left1 <= left2) run1++;
+            if (left2 <= left1) run2++;
+        }
+        return true;
+    }
+
+    // Calls visit(start, end, code) for every run
+    template <typename Visitor>
+    void forEachRun(Visitor visit) const {
+        for (size_t run = 0; run < runCodes.size(); run++) {
+            visit(runStart(run), static_cast<size_t>(runEnds[run]), runCodes[run]);
+        }
+    }
+
+    size_t memoryBytes() const {
+        return runEnds.capacity() * sizeof(uint32_t) + runCodes.capacity() * sizeof(uint16_t) +
+               codeCounts.capacity() * sizeof(size_t);
+    }
+};
+
+class ControlStore {
+    // IDs first, first + 1, ... at positions start, start + 1, ...
+    struct IdRun {
+        int first;
+        uint32_t start;
+        uint32_t length;
+    };
+
+    vector<IdRun> idRuns;
+    StringDictionary typeDictionary;
+    StringDictionary stateDictionary;
+    RunLengthColumn types;
+    RunLengthColumn states;
+
+    bool idRunsSorted = true;   // IDs ascending, so find() can binary search
+
+    size_t idRunAt(size_t position) const {
+        return upper_bound(idRuns.begin(), idRuns.end(), position,
+                           [](size_t p, const IdRun& r) { return p < r.start; }) - idRuns.begin() - 1;
+    }
+
+    // Within an ID run the IDs go up by one, so two segments match when their
+    // first IDs do
+    bool idsEqual(size_t first1, size_t first2, size_t length) const {
+        size_t run1 = idRunAt(first1), run2 = idRunAt(first2);
+        size_t done = 0;
+        while (done < length) {
+            const IdRun& a = idRuns[run1];
+            const IdRun& b = idRuns[run2];
+            size_t offset1 = first1 + done - a.start, offset2 = first2 + done - b.start;
+            if (a.first + static_cast<int>(offset1) != b.first + static_cast<int>(offset2)) {
+                return false;
+            }
+            size_t left1 = a.length - offset1, left2 = b.length - offset2;
+            done += min(left1, left2);
+            if (left1 <= left2) run1++;
+            if (left2 <= left1) run2++;
+        }
+        return true;
+    }
+
+    void push_back(int id, uint16_t typeCode, uint16_t stateCode) {
+        uint32_t position = static_cast<uint32_t>(size());
+        if (!idRuns.empty() && idRuns.back().first + static_cast<int>(idRuns.back().length) == id) {
+            idRuns.back().length++;
+        } else {
+            if (!idRuns.empty() && id < idRuns.back().first + static_cast<int>(idRuns.back().length)) {
+                idRunsSorted = false;
+            }
+            idRuns.push_back({id, position, 1});
+        }
+        types.push_back(typeCode);
+        states.push_back(stateCode);
+    }
+
+public:
+    static constexpr size_t npos = RunLengthColumn::npos;
+
+    ControlStore() = default;
+
+    explicit ControlStore(const vector<Control>& controls) {
+        for (const Control& control : controls) {
+            push_back(control);
+        }
+    }
+
+    // Straight from a mapped snapshot: each snapshot string code is interned
+    // once, then every record is appended as codes, without building a
+    // Control or a string per record
+    explicit ControlStore(const snapshot::Snapshot& controls) {
+        const uint16_t unmapped = numeric_limits<uint16_t>::max();
+        vector<uint16_t> typeCodes(controls.stringCount(), unmapped);
+        vector<uint16_t> stateCodes(controls.stringCount(), unmapped);
+        auto codeFor = [&](vector<uint16_t>& codes, StringDictionary& dictionary, uint16_t code) {
+            if (code >= codes.size()) {
+                throw runtime_error("snapshot string code out of range");
+            }
+            if (codes[code] == unmapped) {
+                codes[code] = dictionary.intern(string(controls.string(code)));
+            }
+            return codes[code];
+        };
+        for (const snapshot::Record& record : controls) {
+            push_back(record.id, codeFor(typeCodes, typeDictionary, record.type),
+                      codeFor(stateCodes, stateDictionary, record.state));
+        }
+    }
+
+    void push_back(const Control& control) {
+        push_back(control.id, typeDictionary.intern(control.type), stateDictionary.intern(control.state));
+    }
+
+    size_t size() const { return states.size(); }
+
+    Control at(size_t position) const {
+        const IdRun& run = idRuns[idRunAt(position)];
+        return {run.first + static_cast<int>(position - run.start), typeDictionary.value(types.at(position)),
+                stateDictionary.value(states.at(position))};
+    }
+
+    // Position of the control with `id`, or npos
+    size_t find(int id) const {
+        if (idRunsSorted) {
+            auto run = upper_bound(idRuns.begin(), idRuns.end(), id,
+                                   [](int value, const IdRun& r) { return value < r.first; });
+            if (run == idRuns.begin()) {
+                return npos;
+            }
+            --run;
+            return id - run->first < static_cast<int>(run->length) ? run->start + (id - run->first) : npos;
+        }
+        for (const IdRun& run : idRuns) {
+            if (id >= run.first && id - run.first < static_cast<int>(run.length)) {
+                return run.start + (id - run.first);
+            }
+        }
+        return npos;
+    }
+
+    // First control in `state`, or npos
+    size_t findState(const string& state) const {
+        uint16_t code;
+        return stateDictionary.find(state, code) ? states.find(code) : npos;
+    }
+
+    // First control whose state equals the next control's, or npos
+    size_t adjacentSameState() const { return states.adjacentRepeat(); }
+
+    size_t countState(const string& state) const {
+        uint16_t code;
+        return stateDictionary.find(state, code) ? states.count(code) : 0;
+    }
+
+    // Controls of `type` in `state`: merges the runs of both columns
+    size_t countTypeState(const string& type, const string& state) const {
+        uint16_t typeCode, stateCode;
+        if (!typeDictionary.find(type, typeCode) || !stateDictionary.find(state, stateCode)) {
+            return 0;
+        }
+        vector<pair<size_t, size_t>> typeRanges;
+        types.forEachRun([&](size_t start, size_t end, uint16_t code) {
+            if (code == typeCode) {
+                typeRanges.push_back({start, end});
+            }
+        });
+        size_t total = 0;
+        size_t next = 0;
+        states.forEachRun([&](size_t start, size_t end, uint16_t code) {
+            if (code != stateCode) {
+                return;
+            }
+            while (next < typeRanges.size() && typeRanges[next].second <= start) {
+                next++;
+            }
+            for (size_t i = next; i < typeRanges.size() && typeRanges[i].first < end; i++) {
+                total += min(end, typeRanges[i].second) - max(start, typeRanges[i].first);
+            }
+        });
+        return total;
+    }
+
+    // Like std::equal on two subranges of whole controls (ID, type and state)
+    bool equal(size_t first1, size_t first2, size_t length) const {
+        return length == 0 || (idsEqual(first1, first2, length) && equalStates(first1, first2, length));
+    }
+
+    // Type and state only, which is what dashboards compare in practice
+    bool equalStates(size_t first1, size_t first2, size_t length) const {
+        return types.equal(first1, first2, length) && states.equal(first1, first2, length);
+    }
+
+    size_t memoryBytes() const {
+        return sizeof(*this) + idRuns.capacity() * sizeof(IdRun) + typeDictionary.memoryBytes() +
+               stateDictionary.memoryBytes() + types.memoryBytes() + states.memoryBytes();
+    }
+};
+
+// Bytes held by a row store of controls, including string storage
+size_t rowMemoryBytes(const vector<Control>& controls) {
+    size_t bytes = sizeof(controls) + controls.capacity() * sizeof(Control);
+    for (const Control& control : controls) {
+        bytes += control.type.capacity() > 15 ? control.type.capacity() + 1 : 0;
+        bytes += control.state.capacity() > 15 ? control.state.capacity() + 1 : 0;
+    }
+    return bytes;
+}
  
-int main() {
+// Queries 4 to 7 on the columnar store
+void reportStore(const ControlStore& store) {
+    size_t repeat = store.adjacentSameState();
+    if (repeat != ControlStore::npos) {
+        cout << "Consecutive controls with the same state start at:" << endl;
+        printControl(store.at(repeat));
+    }
+    cout << "Visible controls: " << store.countState("visible") << endl;
+    cout << "Disabled sliders: " << store.countTypeState("slider", "disabled") << endl;
+    cout << "First two identical to the next two? " << (store.size() >= 4 && store.equal(0, 2, 2) ? "Yes" : "No") << endl;
+}
+ 
+#ifndef HMI_NO_MAIN
+int main(int argc, char** argv) {
     // Initialize the container with sample controls
     vector<Control> controls = {
         {1, "button", "visible"}, {2, "button", "invisible"}, 
@@ -57,6 +404,24 @@ int main() {
         {7, "slider", "invisible"}, {8, "slider", "disabled"}, 
         {9, "slider", "disabled"}, {10, "slider", "visible"}
     };
+    // `--snapshot=path` boots from a control snapshot (see Prgm8) instead:
+    // the columnar store is built from the mapped records and answers the
+    // queries, with no row copy of the controls
+    string arg = argc > 1 ? argv[1] : "";
+    if (arg.rfind("--snapshot=", 0) == 0) {
+        snapshot::Snapshot mapped(arg.substr(11));
+        ControlStore store(mapped);
+        cout << "Columnar store from " << arg.substr(11) << " (" << store.size() << " controls):" << endl;
+        size_t found = store.find(3);
+        if (found != ControlStore::npos) {
+            cout << "Control with ID 3 found:" << endl;
+            printControl(store.at(found));
+        }
+        reportStore(store);
+        cout << "Memory: " << store.memoryBytes() << " bytes columnar vs " << mapped.fileBytes()
+             << " bytes mapped" << endl;
+        return 0;
+    }
  
     // 1. std::for_each: Iterate through all controls and print their details
     cout << "All controls:" << endl;
@@ -118,6 +483,15 @@ int main() {
     } else {
         cout << "Not enough controls to compare subranges." << endl;
     }
+    cout << endl;
+ 
+    // 8. The same queries on the compressed columnar store
+    ControlStore store(controls);
+    cout << "Columnar store:" << endl;
+    reportStore(store);
+    cout << "Memory: " << store.memoryBytes() << " bytes columnar vs " << rowMemoryBytes(controls)
+         << " bytes as rows" << endl;
  
     return 0;
 }
+#endif
@@ -25,7 +25,351 @@ Print the widget list dynamically and show results of widget searches.*/
 #include <vector>
 #include <set>
 #include <algorithm>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
 
+enum class WidgetKind { Dynamic, Static };
+
+using WidgetHandle = std::uint32_t;
+
+// Registry of interned widget names. Each name is stored once and mapped to a
+// handle through a flat open-addressing table (linear probing). Handles are
+// issued in insertion order, so iterating the registry gives a stable render
+// order for dynamic and static widgets together without copying them.
+class WidgetRegistry {
+public:
+    struct Widget {
+        std::string name;
+        WidgetKind kind;
+        std::size_t hash;
+    };
+
+    static constexpr WidgetHandle npos = UINT32_MAX;
+
+    // Returns the existing handle if the name is already registered
+    WidgetHandle add(std::string_view name, WidgetKind kind) {
+        std::size_t hash = std::hash<std::string_view>{}(name);
+        WidgetHandle existing = lookup(name, hash);
+        if (existing != npos) {
+            return existing;
+        }
+
+        if ((widgets.size() + 1) * 2 > slots.size()) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+
+        WidgetHandle handle = static_cast<WidgetHandle>(widgets.size());
+        widgets.push_back({std::string(name), kind, hash});
+        place(handle, hash);
+        return handle;
+    }
+
+    // O(1) average, no allocation for string literals or views
+    WidgetHandle find(std::string_view name) const {
+        return lookup(name, std::hash<std::string_view>{}(name));
+    }
+
+    bool contains(std::string_view name) const { return find(name) != npos; }
+
+    const Widget& operator[](WidgetHandle handle) const { return widgets[handle]; }
+    std::size_t size() const { return widgets.size(); }
+
+    std::vector<Widget>::const_iterator begin() const { return widgets.begin(); }
+    std::vector<Widget>::const_iterator end() const { return widgets.end(); }
+
+private:
+    std::vector<Widget> widgets;      // indexed by handle, in insertion order
+    std::vector<WidgetHandle> slots;  // power-of-two table, npos marks empty
+
+    WidgetHandle lookup(std::string_view name, std::size_t hash) const {
+        if (slots.empty()) {
+            return npos;
+        }
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            WidgetHandle handle = slots[i];
+            if (handle == npos) {
+                return npos;
+            }
+            if (widgets[handle].hash == hash && widgets[handle].name == name) {
+                return handle;
+            }
+        }
+    }
+
+    void place(WidgetHandle handle, std::size_t hash) {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = hash & mask;
+        while (slots[i] != npos) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = handle;
+    }
+
+    void rehash(std::size_t capacity) {
+        slots.assign(capacity, npos);
+        for (WidgetHandle handle = 0; handle < widgets.size(); handle++) {
+            place(handle, widgets[handle].hash);
+        }
+    }
+};
+
+// Lazy view that iterates several containers back to back as one sequence,
+// without copying. The containers may be of different types (vector, set, ...)
+// as long as they hold the same element type. The iterator is a forward
+// iterator, so standard algorithms like std::find work on the view directly.
+template <typename... Containers>
+class JoinedView {
+    static constexpr std::size_t N = sizeof...(Containers);
+    using Iterators = std::tuple<typename Containers::const_iterator...>;
+
+    std::tuple<const Containers&...> containers;
+
+public:
+    using value_type = std::common_type_t<typename Containers::value_type...>;
+    static_assert((std::is_same_v<value_type, typename Containers::value_type> && ...),
+                  "joined containers must share an element type");
+
+    class iterator {
+        Iterators current;
+        Iterators ends;
+        std::size_t segment; // index of the container being walked, N at the end
+
+        template <std::size_t I = 0>
+        const value_type& dereference() const {
+            if constexpr (I + 1 < N) {
+                if (segment != I) {
+                    return dereference<I + 1>();
+                }
+            }
+            return *std::get<I>(current);
+        }
+
+        template <std::size_t I = 0>
+        void advance() {
+            if constexpr (I < N) {
+                if (segment == I) {
+                    ++std::get<I>(current);
+                } else {
+                    advance<I + 1>();
+                }
+            }
+        }
+
+        // Move past exhausted (or empty) containers
+        template <std::size_t I = 0>
+        void skipExhausted() {
+            if constexpr (I < N) {
+                if (segment == I && std::get<I>(current) == std::get<I>(ends)) {
+                    ++segment;
+                }
+                skipExhausted<I + 1>();
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = JoinedView::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        iterator() : segment(N) {}
+        iterator(Iterators current, Iterators ends, std::size_t segment)
+            : current(current), ends(ends), segment(segment) {
+            skipExhausted();
+        }
+
+        reference operator*() const { return dereference(); }
+        pointer operator->() const { return &dereference(); }
+
+        iterator& operator++() {
+            advance();
+            skipExhausted();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const iterator& other) const {
+            return segment == other.segment && current == other.current;
+        }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    };
+
+    explicit JoinedView(const Containers&... containers) : containers(containers...) {}
+
+    iterator begin() const {
+        return iterator(beginIterators(std::index_sequence_for<Containers...>{}),
+                        endIterators(std::index_sequence_for<Containers...>{}), 0);
+    }
+
+    iterator end() const {
+        Iterators ends = endIterators(std::index_sequence_for<Containers...>{});
+        return iterator(ends, ends, N);
+    }
+
+private:
+    template <std::size_t... I>
+    Iterators beginIterators(std::index_sequence<I...>) const {
+        return Iterators(std::get<I>(containers).begin()...);
+    }
+
+    template <std::size_t... I>
+    Iterators endIterators(std::index_sequence<I...>) const {
+        return Iterators(std::get<I>(containers).end()...);
+    }
+};
+
+template <typename... Containers>
+JoinedView<Containers...> joined(const Containers&... containers) {
+    return JoinedView<Containers...>(containers...);
+}
+
+struct Rect {
+    int x, y, width, height;
+
+    bool overlaps(const Rect& other) const {
+        return x <= other.x + other.width && other.x <= x + width &&
+               y <= other.y + other.height && other.y <= y + height;
+    }
+
+    Rect united(const Rect& other) const {
+        int left = std::min(x, other.x), top = std::min(y, other.y);
+        int right = std::max(x + width, other.x + other.width);
+        int bottom = std::max(y + height, other.y + other.height);
+        return {left, top, right - left, bottom - top};
+    }
+
+    bool operator==(const Rect& other) const {
+        return x == other.x && y == other.y && width == other.width && height == other.height;
+    }
+    bool operator!=(const Rect& other) const { return !(*this == other); }
+};
+
+// Tracks which registered widgets need re-highlighting. Every change bumps the
+// widget's version and queues it once on a dirty list, so a frame only visits
+// widgets that changed since the last frame, never the whole registry.
+class HighlightEngine {
+public:
+    struct Frame {
+        std::vector<WidgetHandle> widgets; // widgets to re-highlight
+        std::vector<Rect> dirtyRects;      // merged screen regions to redraw
+    };
+
+    void setBounds(WidgetHandle handle, const Rect& bounds) {
+        WidgetState& state = stateFor(handle);
+        if (state.version != 0 && state.bounds == bounds) {
+            return;
+        }
+        state.bounds = bounds;
+        markDirty(handle);
+    }
+
+    void setActive(WidgetHandle handle, bool active) {
+        WidgetState& state = stateFor(handle);
+        if (state.active != active) {
+            state.active = active;
+            markDirty(handle);
+        }
+    }
+
+    bool isActive(WidgetHandle handle) const {
+        return handle < states.size() && states[handle].active;
+    }
+
+    // Collect everything that changed since the previous frame
+    Frame nextFrame() {
+        Frame frame;
+        for (WidgetHandle handle : dirty) {
+            WidgetState& state = states[handle];
+            state.queued = false;
+            if (state.version == state.renderedVersion) {
+                continue;
+            }
+            frame.widgets.push_back(handle);
+            addDirtyRect(frame.dirtyRects, state.bounds);
+            if (state.renderedVersion != 0) {
+                addDirtyRect(frame.dirtyRects, state.renderedBounds);
+            }
+            state.renderedVersion = state.version;
+            state.renderedBounds = state.bounds;
+        }
+        dirty.clear();
+        return frame;
+    }
+
+private:
+    struct WidgetState {
+        Rect bounds{0, 0, 0, 0};
+        Rect renderedBounds{0, 0, 0, 0}; // where it was last drawn
+        std::uint32_t version = 0;
+        std::uint32_t renderedVersion = 0;
+        bool active = false;
+        bool queued = false;
+    };
+
+    std::vector<WidgetState> states; // indexed by WidgetHandle
+    std::vector<WidgetHandle> dirty;
+
+    WidgetState& stateFor(WidgetHandle handle) {
+        if (handle >= states.size()) {
+            states.resize(handle + 1);
+        }
+        return states[handle];
+    }
+
+    void markDirty(WidgetHandle handle) {
+        WidgetState& state = states[handle];
+        state.version++;
+        if (!state.queued) {
+            state.queued = true;
+            dirty.push_back(handle);
+        }
+    }
+
+    // Merge the rectangle into any overlapping ones until the list is disjoint.
+    // Each pass absorbs every rect the merged one overlaps; another pass is
+    // only needed if it grew, since the list itself is already disjoint.
+    static void addDirtyRect(std::vector<Rect>& rects, Rect rect) {
+        bool grew = true;
+        while (grew) {
+            grew = false;
+            for (std::size_t i = 0; i < rects.size();) {
+                if (rects[i].overlaps(rect)) {
+                    Rect merged = rect.united(rects[i]);
+                    grew = grew || merged != rect;
+                    rect = merged;
+                    rects[i] = rects.back();
+                    rects.pop_back();
+                } else {
+                    i++;
+                }
+            }
+        }
+        rects.push_back(rect);
+    }
+};
+
+void printFrame(const WidgetRegistry& registry, const HighlightEngine& engine, const HighlightEngine::Frame& frame) {
+    for (WidgetHandle handle : frame.widgets) {
+        std::cout << registry[handle].name << (engine.isActive(handle) ? " [highlighted]" : "") << "\n";
+    }
+    for (const auto& rect : frame.dirtyRects) {
+        std::cout << "Redraw region (" << rect.x << ", " << rect.y << ") " << rect.width << "x" << rect.height << "\n";
+    }
+}
+
+#ifndef HMI_NO_MAIN
 int main() {
     std::vector<std::string> dynamicWidgets = {"Speedometer", "Tachometer", "FuelGauge", "Temperature"};
     std::set<std::string> staticWidgets = {"Logo", "WarningLights", "BatteryStatus"};
@@ -41,21 +385,53 @@ int main() {
         std::cout << "\n'WarningLights' is not in the static widgets list.\n";
     }
 
-    std::vector<std::string> allWidgets;
-    allWidgets.insert(allWidgets.end(), dynamicWidgets.begin(), dynamicWidgets.end());
-    allWidgets.insert(allWidgets.end(), staticWidgets.begin(), staticWidgets.end());
+    WidgetRegistry registry;
+    for (const auto& widget : dynamicWidgets) {
+        registry.add(widget, WidgetKind::Dynamic);
+    }
+    for (const auto& widget : staticWidgets) {
+        registry.add(widget, WidgetKind::Static);
+    }
+
+    auto allWidgets = joined(dynamicWidgets, staticWidgets);
 
     std::cout << "\nAll Widgets:\n";
     for (const auto& widget : allWidgets) {
         std::cout << widget << "\n";
     }
 
-    auto it = std::find(allWidgets.begin(), allWidgets.end(), "Tachometer");
+    auto it = std::find(allWidgets.begin(), allWidgets.end(), "BatteryStatus");
     if (it != allWidgets.end()) {
+        std::cout << "\n'BatteryStatus' is found in the combined widgets view.\n";
+    } else {
+        std::cout << "\n'BatteryStatus' is not in the combined widgets view.\n";
+    }
+
+    if (registry.contains("Tachometer")) {
         std::cout << "\n'Tachometer' is found in the combined widgets list.\n";
     } else {
         std::cout << "\n'Tachometer' is not in the combined widgets list.\n";
     }
 
+    // Highlight the active widgets, redrawing only what changed per frame
+    HighlightEngine engine;
+    int column = 0;
+    for (WidgetHandle handle = 0; handle < registry.size(); handle++) {
+        engine.setBounds(handle, {column * 100, registry[handle].kind == WidgetKind::Static ? 400 : 0, 90, 90});
+        column++;
+    }
+    engine.setActive(registry.find("Speedometer"), true);
+    engine.setActive(registry.find("WarningLights"), true);
+
+    std::cout << "\nFrame 1:\n";
+    printFrame(registry, engine, engine.nextFrame());
+
+    engine.setActive(registry.find("Speedometer"), false);
+    engine.setActive(registry.find("Tachometer"), true);
+
+    std::cout << "\nFrame 2:\n";
+    printFrame(registry, engine, engine.nextFrame());
+
     return 0;
 }
+#endif
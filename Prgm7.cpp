@@ -22,6 +22,8 @@ Show intermediate results after each operation.*/
 #include <algorithm>
 #include <random>
 #include <string>
+#include <memory>
+#include "ControlSnapshot.h"
  
 using namespace std;
  
@@ -42,22 +44,45 @@ void printControls(const vector<Control>& controls) {
     cout << "-----------------------" << endl;
 }
  
-int main() {
+// Same listing straight from a mapped snapshot, without copying the records
+void printControls(const snapshot::Snapshot& controls) {
+    for (size_t i = 0; i < controls.size(); i++) {
+        cout << "ID: " << controls[i].id 
+             << ", Type: " << controls.type(i) 
+             << ", State: " << controls.state(i) << endl;
+    }
+    cout << "-----------------------" << endl;
+}
+ 
+#ifndef HMI_NO_MAIN
+int main(int argc, char** argv) {
     // Step 1: Populate the control list
     vector<Control> controls = {
         {1, "button", "visible"}, {2, "slider", "visible"}, 
         {3, "button", "invisible"}, {4, "slider", "disabled"}, 
         {5, "button", "visible"}, {6, "slider", "disabled"}
     };
+    // `--snapshot=path` boots from a control snapshot (see Prgm8) instead.
+    // The mapped file is read-only, so it is both the original list and its
+    // backup; step 3 overwrites every control anyway, so the working list is
+    // only sized from it and the records are never copied into strings.
+    string arg = argc > 1 ? argv[1] : "";
+    unique_ptr<snapshot::Snapshot> mapped;
+    if (arg.rfind("--snapshot=", 0) == 0) {
+        mapped = make_unique<snapshot::Snapshot>(arg.substr(11));
+        controls.assign(mapped->size(), Control{});
+    }
  
     cout << "Original Controls:" << endl;
-    printControls(controls);
+    mapped ? printControls(*mapped) : printControls(controls);
  
     // Step 2: std::copy to create a backup
     vector<Control> backupControls;
-    copy(controls.begin(), controls.end(), back_inserter(backupControls));
+    if (!mapped) {
+        copy(controls.begin(), controls.end(), back_inserter(backupControls));
+    }
     cout << "Backup Controls:" << endl;
-    printControls(backupControls);
+    mapped ? printControls(*mapped) : printControls(backupControls);
  
     // Step 3: std::fill to set all states to "disabled" temporarily
     fill(controls.begin(), controls.end(), Control{0, "reset", "disabled"});
@@ -116,3 +141,4 @@ int main() {
  
     return 0;
 }
+#endif
@@ -18,7 +18,21 @@ Use std::set_union and std::set_intersection to identify common and unique contr
 #include <vector>
 #include <algorithm>
 #include <string>
-#include <set>
+#include <bitset>
+#include <cstdint>
+#include <array>
+#include <utility>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <filesystem>
+#include <stdexcept>
+#include <random>
+#include "ControlSnapshot.h"
  
 using namespace std;
  
@@ -44,7 +58,605 @@ bool compareById(const Control& a, const Control& b) {
     return a.id < b.id;
 }
  
-int main() {
+// LSD radix sort of controls by ID. Only (key, index) pairs are sorted,
+// 8 bits per pass, each pass a stable counting scatter, so equal IDs keep
+// their order; the controls are then moved once into their final place.
+// Passes whose digit is the same for every key are skipped.
+struct KeyIndex {
+    uint32_t key;
+    uint32_t index;
+};
+ 
+const unsigned RADIX_BITS = 8;
+const size_t RADIX_BUCKETS = size_t(1) << RADIX_BITS;
+const size_t PARALLEL_RADIX_MIN_PER_THREAD = 1 << 16;
+ 
+// Flips the sign bit so negative IDs order before positive ones as unsigned
+inline uint32_t radixKey(int id) {
+    return static_cast<uint32_t>(id) ^ 0x80000000u;
+}
+ 
+inline int idFromKey(uint32_t key) {
+    return static_cast<int>(key ^ 0x80000000u);
+}
+ 
+vector<KeyIndex> makeKeyIndex(const vector<Control>& controls) {
+    if (controls.size() > UINT32_MAX) throw runtime_error("too many controls for a radix sort");
+    vector<KeyIndex> pairs(controls.size());
+    for (size_t i = 0; i < controls.size(); i++) pairs[i] = {radixKey(controls[i].id), static_cast<uint32_t>(i)};
+    return pairs;
+}
+ 
+void applyPermutation(vector<Control>& controls, const vector<KeyIndex>& sorted) {
+    vector<Control> result;
+    result.reserve(controls.size());
+    for (const auto& pair : sorted) result.push_back(move(controls[pair.index]));
+    controls.swap(result);
+}
+ 
+void radixSortPairs(vector<KeyIndex>& pairs) {
+    vector<KeyIndex> scratch(pairs.size());
+    for (unsigned shift = 0; shift < 32; shift += RADIX_BITS) {
+        array<size_t, RADIX_BUCKETS> offsets{};
+        for (const auto& pair : pairs) offsets[(pair.key >> shift) & (RADIX_BUCKETS - 1)]++;
+        if (*max_element(offsets.begin(), offsets.end()) == pairs.size()) continue;
+ 
+        size_t start = 0;
+        for (auto& offset : offsets) start += exchange(offset, start);
+        for (const auto& pair : pairs) scratch[offsets[(pair.key >> shift) & (RADIX_BUCKETS - 1)]++] = pair;
+        pairs.swap(scratch);
+    }
+}
+ 
+// A fixed set of threads that runs one task on all of them at a time: the
+// caller is worker 0, so a pool of size 1 starts no threads. A sort reuses
+// the same workers for every pass instead of starting threads per pass.
+class RadixWorkers {
+public:
+    explicit RadixWorkers(unsigned count = thread::hardware_concurrency()) : workerCount(max(count, 1u)) {
+        for (unsigned t = 1; t < workerCount; t++) threads.emplace_back(&RadixWorkers::workerLoop, this, t);
+    }
+ 
+    ~RadixWorkers() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        taskReady.notify_all();
+        for (auto& worker : threads) worker.join();
+    }
+ 
+    RadixWorkers(const RadixWorkers&) = delete;
+    RadixWorkers& operator=(const RadixWorkers&) = delete;
+ 
+    unsigned size() const { return workerCount; }
+ 
+    // Runs task(t) for every t < size() and returns once all have finished
+    void run(const function<void(unsigned)>& task) {
+        {
+            lock_guard<mutex> lock(mtx);
+            current = &task;
+            pendingWorkers = workerCount - 1;
+            generation++;
+        }
+        taskReady.notify_all();
+        task(0);
+        unique_lock<mutex> lock(mtx);
+        taskDone.wait(lock, [this] { return pendingWorkers == 0; });
+        current = nullptr;
+    }
+ 
+private:
+    unsigned workerCount;
+    vector<thread> threads;
+    mutex mtx;
+    condition_variable taskReady;
+    condition_variable taskDone;
+    const function<void(unsigned)>* current = nullptr;
+    uint64_t generation = 0;
+    unsigned pendingWorkers = 0;
+    bool stopping = false;
+ 
+    void workerLoop(unsigned t) {
+        uint64_t seen = 0;
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            taskReady.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            const function<void(unsigned)>& task = *current;
+            lock.unlock();
+            task(t);
+            lock.lock();
+            if (--pendingWorkers == 0) taskDone.notify_one();
+        }
+    }
+};
+ 
+// Blocks to split n pairs into: one per worker, but never less than
+// PARALLEL_RADIX_MIN_PER_THREAD pairs each
+unsigned radixBlocks(size_t n, const RadixWorkers& workers) {
+    return static_cast<unsigned>(min<size_t>(workers.size(), max<size_t>(n / PARALLEL_RADIX_MIN_PER_THREAD, 1)));
+}
+ 
+// Same passes split over the workers: each one counts its block, the counts
+// give every (digit, block) its own output range, and each one scatters its
+// block in order, so the result is stable and identical to the serial sort.
+// Small inputs use fewer blocks than there are workers.
+void parallelRadixSortPairs(vector<KeyIndex>& pairs, RadixWorkers& workers) {
+    size_t n = pairs.size();
+    unsigned blocks = radixBlocks(n, workers);
+    if (blocks == 1) {
+        radixSortPairs(pairs);
+        return;
+    }
+    vector<KeyIndex> scratch(n);
+    vector<array<size_t, RADIX_BUCKETS>> offsets(blocks);
+    auto inParallel = [&workers, blocks](const function<void(unsigned)>& task) {
+        workers.run([&](unsigned t) {
+            if (t < blocks) task(t);
+        });
+    };
+ 
+    for (unsigned shift = 0; shift < 32; shift += RADIX_BITS) {
+        inParallel([&](unsigned t) {
+            offsets[t].fill(0);
+            for (size_t i = n * t / blocks; i < n * (t + 1) / blocks; i++)
+                offsets[t][(pairs[i].key >> shift) & (RADIX_BUCKETS - 1)]++;
+        });
+ 
+        size_t start = 0;
+        bool singleDigit = false;
+        for (size_t digit = 0; digit < RADIX_BUCKETS; digit++) {
+            size_t digitStart = start;
+            for (unsigned t = 0; t < blocks; t++) start += exchange(offsets[t][digit], start);
+            if (start - digitStart == n) singleDigit = true;
+        }
+        if (singleDigit) continue;
+ 
+        inParallel([&](unsigned t) {
+            for (size_t i = n * t / blocks; i < n * (t + 1) / blocks; i++)
+                scratch[offsets[t][(pairs[i].key >> shift) & (RADIX_BUCKETS - 1)]++] = pairs[i];
+        });
+        pairs.swap(scratch);
+    }
+}
+ 
+// Stable sort by ID, like stable_sort(..., compareById)
+void radixSortById(vector<Control>& controls) {
+    vector<KeyIndex> pairs = makeKeyIndex(controls);
+    radixSortPairs(pairs);
+    applyPermutation(controls, pairs);
+}
+ 
+// Moving the controls into sorted order is most of the work, so it is split
+// into blocks on the workers too: each one fills its own range of the result
+void parallelRadixSortById(vector<Control>& controls, RadixWorkers& workers) {
+    vector<KeyIndex> pairs = makeKeyIndex(controls);
+    parallelRadixSortPairs(pairs, workers);
+ 
+    size_t n = pairs.size();
+    unsigned blocks = radixBlocks(n, workers);
+    if (blocks == 1) {
+        applyPermutation(controls, pairs);
+        return;
+    }
+    vector<Control> result(n);
+    workers.run([&](unsigned t) {
+        if (t >= blocks) return;
+        for (size_t i = n * t / blocks; i < n * (t + 1) / blocks; i++) result[i] = move(controls[pairs[i].index]);
+    });
+    controls.swap(result);
+}
+ 
+// Compressed bitmap set for control IDs (Roaring-style).
+// Each ID is offset like radixKey(), so negative IDs come first, and split
+// into a 16-bit key and a 16-bit low part. Every key owns one container: a
+// sorted array while sparse, a 65536-bit bitmap once dense. Array pairs are
+// merged, an array against a bitmap probes the bitmap once per element, and
+// bitmap pairs are plain word loops so the compiler vectorizes them.
+class ControlIdSet {
+    static const size_t ARRAY_LIMIT = 4096;   // above this a bitmap is smaller
+    static const size_t BITMAP_WORDS = 1024;  // 65536 bits
+ 
+    enum class SetOp { Union, Intersection, Difference };
+ 
+    struct Container {
+        uint16_t key = 0;
+        size_t cardinality = 0;
+        vector<uint16_t> array;   // used while sparse
+        vector<uint64_t> bitmap;  // used once dense
+ 
+        bool isBitmap() const { return !bitmap.empty(); }
+    };
+ 
+    vector<Container> containers; // sorted by key
+ 
+    static size_t popcount(uint64_t word) { return bitset<64>(word).count(); }
+    static size_t trailingZeros(uint64_t word) { return bitset<64>((word & (0 - word)) - 1).count(); }
+ 
+    static bool testBit(const vector<uint64_t>& words, uint16_t low) { return (words[low >> 6] >> (low & 63)) & 1; }
+ 
+    static vector<uint64_t> asBitmap(const Container& c) {
+        if (c.isBitmap()) return c.bitmap;
+        vector<uint64_t> words(BITMAP_WORDS, 0);
+        for (uint16_t low : c.array) words[low >> 6] |= uint64_t(1) << (low & 63);
+        return words;
+    }
+ 
+    // Switch a container to the smaller representation for its cardinality
+    static void normalize(Container& c) {
+        if (c.isBitmap() && c.cardinality <= ARRAY_LIMIT) {
+            c.array.reserve(c.cardinality);
+            for (size_t i = 0; i < BITMAP_WORDS; i++) {
+                for (uint64_t w = c.bitmap[i]; w != 0; w &= w - 1) {
+                    c.array.push_back(static_cast<uint16_t>(i * 64 + trailingZeros(w)));
+                }
+            }
+            vector<uint64_t>().swap(c.bitmap);
+        } else if (!c.isBitmap() && c.cardinality > ARRAY_LIMIT) {
+            c.bitmap = asBitmap(c);
+            vector<uint16_t>().swap(c.array);
+        }
+    }
+ 
+    static Container combine(const Container& x, const Container& y, SetOp op) {
+        Container out;
+        out.key = x.key;
+        if (!x.isBitmap() && !y.isBitmap()) {
+            auto sink = back_inserter(out.array);
+            switch (op) {
+            case SetOp::Union:
+                set_union(x.array.begin(), x.array.end(), y.array.begin(), y.array.end(), sink);
+                break;
+            case SetOp::Intersection:
+                set_intersection(x.array.begin(), x.array.end(), y.array.begin(), y.array.end(), sink);
+                break;
+            case SetOp::Difference:
+                set_difference(x.array.begin(), x.array.end(), y.array.begin(), y.array.end(), sink);
+                break;
+            }
+            out.cardinality = out.array.size();
+        } else if (!x.isBitmap() || !y.isBitmap()) {
+            const Container& sparse = x.isBitmap() ? y : x;
+            const Container& dense = x.isBitmap() ? x : y;
+            if (op == SetOp::Intersection || (op == SetOp::Difference && !x.isBitmap())) {
+                // Keep the array elements the bitmap has (or lacks, for array - bitmap)
+                bool keepPresent = op == SetOp::Intersection;
+                for (uint16_t low : sparse.array) {
+                    if (testBit(dense.bitmap, low) == keepPresent) out.array.push_back(low);
+                }
+                out.cardinality = out.array.size();
+            } else {
+                // Union, or bitmap - array: edit a copy of the bitmap
+                bool adding = op == SetOp::Union;
+                out.bitmap = dense.bitmap;
+                out.cardinality = dense.cardinality;
+                for (uint16_t low : sparse.array) {
+                    uint64_t& word = out.bitmap[low >> 6];
+                    uint64_t bit = uint64_t(1) << (low & 63);
+                    if (((word & bit) != 0) == adding) continue;
+                    word ^= bit;
+                    if (adding) out.cardinality++;
+                    else out.cardinality--;
+                }
+            }
+        } else {
+            const vector<uint64_t>& a = x.bitmap;
+            const vector<uint64_t>& b = y.bitmap;
+            out.bitmap.resize(BITMAP_WORDS);
+            switch (op) {
+            case SetOp::Union:
+                for (size_t i = 0; i < BITMAP_WORDS; i++) out.bitmap[i] = a[i] | b[i];
+                break;
+            case SetOp::Intersection:
+                for (size_t i = 0; i < BITMAP_WORDS; i++) out.bitmap[i] = a[i] & b[i];
+                break;
+            case SetOp::Difference:
+                for (size_t i = 0; i < BITMAP_WORDS; i++) out.bitmap[i] = a[i] & ~b[i];
+                break;
+            }
+            for (uint64_t w : out.bitmap) out.cardinality += popcount(w);
+        }
+        normalize(out);
+        return out;
+    }
+ 
+    static ControlIdSet apply(const ControlIdSet& a, const ControlIdSet& b, SetOp op) {
+        ControlIdSet result;
+        size_t i = 0, j = 0;
+        while (i < a.containers.size() || j < b.containers.size()) {
+            if (j == b.containers.size() || (i < a.containers.size() && a.containers[i].key < b.containers[j].key)) {
+                if (op != SetOp::Intersection) result.containers.push_back(a.containers[i]);
+                i++;
+            } else if (i == a.containers.size() || b.containers[j].key < a.containers[i].key) {
+                if (op == SetOp::Union) result.containers.push_back(b.containers[j]);
+                j++;
+            } else {
+                Container c = combine(a.containers[i], b.containers[j], op);
+                if (c.cardinality > 0) result.containers.push_back(move(c));
+                i++;
+                j++;
+            }
+        }
+        return result;
+    }
+ 
+public:
+    void insert(int id) {
+        uint32_t value = radixKey(id);
+        uint16_t key = static_cast<uint16_t>(value >> 16);
+        uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+ 
+        auto pos = lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+        if (pos == containers.end() || pos->key != key) {
+            pos = containers.insert(pos, Container());
+            pos->key = key;
+        }
+ 
+        Container& c = *pos;
+        if (c.isBitmap()) {
+            uint64_t bit = uint64_t(1) << (low & 63);
+            if ((c.bitmap[low >> 6] & bit) == 0) {
+                c.bitmap[low >> 6] |= bit;
+                c.cardinality++;
+            }
+        } else {
+            auto it = lower_bound(c.array.begin(), c.array.end(), low);
+            if (it == c.array.end() || *it != low) {
+                c.array.insert(it, low);
+                c.cardinality++;
+                normalize(c);
+            }
+        }
+    }
+ 
+    bool contains(int id) const {
+        uint32_t value = radixKey(id);
+        uint16_t key = static_cast<uint16_t>(value >> 16);
+        uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+ 
+        auto pos = lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+        if (pos == containers.end() || pos->key != key) return false;
+        if (pos->isBitmap()) return testBit(pos->bitmap, low);
+        return binary_search(pos->array.begin(), pos->array.end(), low);
+    }
+ 
+    size_t cardinality() const {
+        size_t total = 0;
+        for (const auto& c : containers) total += c.cardinality;
+        return total;
+    }
+ 
+    // Visit every ID in ascending order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const auto& c : containers) {
+            uint32_t high = uint32_t(c.key) << 16;
+            if (c.isBitmap()) {
+                for (size_t i = 0; i < BITMAP_WORDS; i++) {
+                    for (uint64_t w = c.bitmap[i]; w != 0; w &= w - 1) {
+                        visit(idFromKey(high | static_cast<uint32_t>(i * 64 + trailingZeros(w))));
+                    }
+                }
+            } else {
+                for (uint16_t low : c.array) visit(idFromKey(high | low));
+            }
+        }
+    }
+ 
+    static ControlIdSet unite(const ControlIdSet& a, const ControlIdSet& b) { return apply(a, b, SetOp::Union); }
+    static ControlIdSet intersect(const ControlIdSet& a, const ControlIdSet& b) { return apply(a, b, SetOp::Intersection); }
+    static ControlIdSet subtract(const ControlIdSet& a, const ControlIdSet& b) { return apply(a, b, SetOp::Difference); }
+};
+ 
+// Binary record layout for spilled controls: int32 id, then type and state as
+// uint16 length + bytes. Returns the number of bytes written.
+size_t writeControl(ostream& out, const Control& control) {
+    int32_t id = control.id;
+    out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    size_t bytes = sizeof(id);
+    for (const string* field : {&control.type, &control.state}) {
+        if (field->size() > UINT16_MAX) {
+            throw runtime_error("control " + to_string(control.id) + " has a field longer than 65535 bytes");
+        }
+        uint16_t length = static_cast<uint16_t>(field->size());
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(field->data(), length);
+        bytes += sizeof(length) + length;
+    }
+    return bytes;
+}
+ 
+// False at the end of the stream or on a truncated record
+bool readControl(istream& in, Control& control) {
+    int32_t id;
+    if (!in.read(reinterpret_cast<char*>(&id), sizeof(id))) return false;
+    control.id = id;
+    for (string* field : {&control.type, &control.state}) {
+        uint16_t length;
+        if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) return false;
+        field->resize(length);
+        if (length > 0 && !in.read(&(*field)[0], length)) return false;
+    }
+    return true;
+}
+ 
+// Merged on-disk control list with a sparse index of every INDEX_STRIDE-th ID,
+// so lower_bound/upper_bound seek close to the answer and scan one block
+class SortedControlFile {
+    static const size_t INDEX_STRIDE = 1024;
+ 
+    string path;
+    size_t count = 0;
+    vector<pair<int, streamoff>> sparseIndex; // (id, offset) of every stride-th record
+ 
+    // Scan from the last indexed record that cannot be the answer
+    bool scan(int id, bool strict, Control& result) const {
+        auto pos = lower_bound(sparseIndex.begin(), sparseIndex.end(), id,
+                               [strict](const pair<int, streamoff>& entry, int key) {
+                                   return strict ? entry.first <= key : entry.first < key;
+                               });
+        streamoff start = pos == sparseIndex.begin() ? 0 : prev(pos)->second;
+ 
+        ifstream in(path, ios::binary);
+        in.seekg(start);
+        Control control;
+        while (readControl(in, control)) {
+            if (strict ? control.id > id : control.id >= id) {
+                result = control;
+                return true;
+            }
+        }
+        return false;
+    }
+ 
+public:
+    SortedControlFile(const string& path) : path(path) {}
+ 
+    void indexRecord(int id, streamoff offset) {
+        if (count++ % INDEX_STRIDE == 0) sparseIndex.push_back({id, offset});
+    }
+ 
+    size_t size() const { return count; }
+    const string& filePath() const { return path; }
+ 
+    // First control with id >= searchId
+    bool lowerBound(int searchId, Control& result) const { return scan(searchId, false, result); }
+ 
+    // First control with id > searchId
+    bool upperBound(int searchId, Control& result) const { return scan(searchId, true, result); }
+};
+ 
+// Creates a new, empty directory under the system temp directory. The name
+// is `prefix` plus a random suffix, so concurrent runs get their own runs
+// and never delete each other's files.
+string makeWorkDir(const string& prefix) {
+    random_device entropy;
+    for (int attempt = 0; attempt < 100; attempt++) {
+        filesystem::path dir = filesystem::temp_directory_path() / (prefix + "_" + to_string(entropy()));
+        if (filesystem::create_directory(dir)) return dir.string();
+    }
+    throw runtime_error("cannot create a work directory for " + prefix);
+}
+ 
+// External merge sort for control lists that do not fit in memory.
+// Controls are buffered into chunks; each full chunk is radix-sorted on a
+// worker thread and spilled as a binary run. finish() k-way merges the runs
+// with a loser tree; ties go to the earlier run, so the result is stable.
+class ExternalControlSorter {
+    string workDir;
+    size_t chunkSize;
+    unsigned maxThreads;
+ 
+    vector<Control> buffer;
+    vector<string> runPaths;
+    vector<future<void>> pending;
+ 
+    struct RunReader {
+        ifstream in;
+        Control current;
+        bool exhausted = false;
+ 
+        RunReader(const string& path) : in(path, ios::binary) { advance(); }
+        void advance() { exhausted = !readControl(in, current); }
+    };
+ 
+    void spill() {
+        if (buffer.empty()) return;
+        if (pending.size() >= maxThreads) {
+            pending.front().get();
+            pending.erase(pending.begin());
+        }
+ 
+        string path = workDir + "/run" + to_string(runPaths.size()) + ".bin";
+        runPaths.push_back(path);
+        pending.push_back(async(launch::async, [path](vector<Control> chunk) {
+            radixSortById(chunk);
+            ofstream out(path, ios::binary);
+            if (!out) throw runtime_error("cannot write run file " + path);
+            for (const auto& control : chunk) writeControl(out, control);
+        }, move(buffer)));
+ 
+        buffer.clear();
+        buffer.reserve(chunkSize);
+    }
+ 
+public:
+    ExternalControlSorter(const string& workDir, size_t chunkSize, unsigned threads = thread::hardware_concurrency())
+        : workDir(workDir), chunkSize(chunkSize), maxThreads(max(threads, 1u)) {
+        filesystem::create_directories(workDir);
+        buffer.reserve(chunkSize);
+    }
+ 
+    void add(const Control& control) {
+        buffer.push_back(control);
+        if (buffer.size() >= chunkSize) spill();
+    }
+ 
+    SortedControlFile finish(const string& outputPath) {
+        spill();
+        for (auto& run : pending) run.get();
+        pending.clear();
+ 
+        vector<unique_ptr<RunReader>> runs;
+        for (const auto& path : runPaths) runs.push_back(make_unique<RunReader>(path));
+        size_t k = runs.size();
+ 
+        // Loser tree: tree[node] holds the run that lost the match at that
+        // node, tree[0] the overall winner. Leaves are runs k..2k-1.
+        auto beats = [&runs](size_t a, size_t b) {
+            if (runs[a]->exhausted) return false;
+            if (runs[b]->exhausted) return true;
+            if (runs[a]->current.id != runs[b]->current.id) return runs[a]->current.id < runs[b]->current.id;
+            return a < b;
+        };
+        vector<size_t> tree(max(k, size_t(1)));
+        function<size_t(size_t)> build = [&](size_t node) -> size_t {
+            if (node >= k) return node - k;
+            size_t left = build(2 * node), right = build(2 * node + 1);
+            if (beats(left, right)) {
+                tree[node] = right;
+                return left;
+            }
+            tree[node] = left;
+            return right;
+        };
+ 
+        SortedControlFile result(outputPath);
+        ofstream out(outputPath, ios::binary);
+        if (!out) throw runtime_error("cannot write merged file " + outputPath);
+ 
+        if (k > 0) {
+            tree[0] = build(1);
+            streamoff offset = 0; // tracked from the record sizes; tellp() would flush
+            while (!runs[tree[0]]->exhausted) {
+                size_t winner = tree[0];
+                result.indexRecord(runs[winner]->current.id, offset);
+                offset += static_cast<streamoff>(writeControl(out, runs[winner]->current));
+                runs[winner]->advance();
+ 
+                // Replay the winner's path to the root
+                for (size_t node = (winner + k) / 2; node >= 1; node /= 2) {
+                    if (beats(tree[node], winner)) swap(tree[node], winner);
+                }
+                tree[0] = winner;
+            }
+        }
+        out.close();
+        if (!out) throw runtime_error("cannot write merged file " + outputPath);
+ 
+        runs.clear();
+        for (const auto& path : runPaths) filesystem::remove(path);
+        runPaths.clear();
+        return result;
+    }
+};
+ 
+#ifndef HMI_NO_MAIN
+int main(int argc, char** argv) {
     // Step 1: Initialize two lists of controls
     vector<Control> controls1 = {
         {5, "button", "visible"}, {2, "slider", "disabled"}, {8, "button", "invisible"}
@@ -60,9 +672,23 @@ int main() {
     printControls(controls2);
  
     // Step 2: Sorting
+    vector<Control> radixSorted1 = controls1, radixSorted2 = controls2;
     sort(controls1.begin(), controls1.end(), compareById);
     sort(controls2.begin(), controls2.end(), compareById);
  
+    // Radix sort (stable, no comparisons: the fast path for large lists) on
+    // the same input must give the same order
+    RadixWorkers workers(2);
+    radixSortById(radixSorted1);
+    parallelRadixSortById(radixSorted2, workers);
+    auto sameOrder = [](const vector<Control>& a, const vector<Control>& b) {
+        return equal(a.begin(), a.end(), b.begin(), b.end(), [](const Control& x, const Control& y) {
+            return x.id == y.id && x.type == y.type && x.state == y.state;
+        });
+    };
+    cout << "Radix sort matches std::sort: "
+         << (sameOrder(controls1, radixSorted1) && sameOrder(controls2, radixSorted2) ? "yes" : "no") << endl;
+ 
     cout << "Sorted Controls List 1:" << endl;
     printControls(controls1);
  
@@ -101,21 +727,74 @@ int main() {
     printControls(combinedControls);
  
     // Step 6: Set Operations
-    set<int> ids1, ids2, unionIds, intersectionIds;
+    ControlIdSet ids1, ids2;
  
     for (const auto& control : controls1) ids1.insert(control.id);
     for (const auto& control : controls2) ids2.insert(control.id);
  
-    set_union(ids1.begin(), ids1.end(), ids2.begin(), ids2.end(), inserter(unionIds, unionIds.begin()));
-    set_intersection(ids1.begin(), ids1.end(), ids2.begin(), ids2.end(), inserter(intersectionIds, intersectionIds.begin()));
+    ControlIdSet unionIds = ControlIdSet::unite(ids1, ids2);
+    ControlIdSet intersectionIds = ControlIdSet::intersect(ids1, ids2);
+    ControlIdSet differenceIds = ControlIdSet::subtract(ids1, ids2);
+ 
+    cout << "Union of IDs (" << unionIds.cardinality() << "):" << endl;
+    unionIds.forEach([](int id) { cout << id << " "; });
+    cout << endl;
  
-    cout << "Union of IDs:" << endl;
-    for (int id : unionIds) cout << id << " ";
+    cout << "Intersection of IDs (" << intersectionIds.cardinality() << "):" << endl;
+    intersectionIds.forEach([](int id) { cout << id << " "; });
     cout << endl;
  
-    cout << "Intersection of IDs:" << endl;
-    for (int id : intersectionIds) cout << id << " ";
+    cout << "Difference of IDs, List 1 - List 2 (" << differenceIds.cardinality() << "):" << endl;
+    differenceIds.forEach([](int id) { cout << id << " "; });
     cout << endl;
  
+    // Step 7: External sort for control lists larger than memory
+    // (tiny chunks here so the demo spills several runs to disk)
+    string workDir = makeWorkDir("prgm8_sort");
+    ExternalControlSorter sorter(workDir, 2);
+    for (const auto& control : controls2) sorter.add(control);
+    for (const auto& control : controls1) sorter.add(control);
+    SortedControlFile sortedFile = sorter.finish(workDir + "/merged.bin");
+ 
+    cout << "-----------------------" << endl;
+    cout << "External sort wrote " << sortedFile.size() << " controls to disk." << endl;
+ 
+    Control onDisk;
+    if (sortedFile.lowerBound(searchId, onDisk) && onDisk.id == searchId) {
+        cout << "Control with ID " << searchId << " found on disk using lower_bound:" << endl;
+        cout << "ID: " << onDisk.id << ", Type: " << onDisk.type << ", State: " << onDisk.state << endl;
+    } else {
+        cout << "Control with ID " << searchId << " not found on disk." << endl;
+    }
+    cout << "Upper bound on disk points to control with ID: "
+         << (sortedFile.upperBound(searchId, onDisk) ? to_string(onDisk.id) : "None") << endl;
+ 
+    // Step 8: Binary snapshot, written in two steps and mapped back in place
+    // (`--snapshot-out=path` keeps it for Prgm5/Prgm7 `--snapshot=path`)
+    string arg = argc > 1 ? argv[1] : "";
+    string snapshotPath = arg.rfind("--snapshot-out=", 0) == 0 ? arg.substr(15) : workDir + "/controls.snap";
+    {
+        snapshot::Writer writer(snapshotPath);
+        writer.add(controls1.begin(), controls1.end());
+    }
+    {
+        snapshot::Writer writer(snapshotPath, snapshot::Writer::Append);
+        writer.add(controls2.begin(), controls2.end());
+    }
+    snapshot::Snapshot mapped(snapshotPath);
+    uint16_t sliderCode;
+    size_t sliders = 0;
+    if (mapped.find("slider", sliderCode)) {
+        for (const auto& record : mapped) sliders += record.type == sliderCode;
+    }
+    cout << "-----------------------" << endl;
+    cout << "Snapshot v" << mapped.version() << " holds " << mapped.size() << " controls (" << sliders
+         << " sliders) in " << mapped.fileBytes() << " bytes." << endl;
+    cout << "Last control in snapshot: ID: " << mapped[mapped.size() - 1].id << ", Type: " << mapped.type(mapped.size() - 1)
+         << ", State: " << mapped.state(mapped.size() - 1) << endl;
+ 
+    filesystem::remove_all(workDir);
+ 
     return 0;
 }
+#endif
@@ -21,73 +21,322 @@ cppCopy codeclass ModeObserver {public:    virtual void update(const std::string
 #include <string>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <unordered_map>
+#include <type_traits>
+#include <typeinfo>
+#include <cstddef>
+#include <new>
+#include <variant>
+#include <array>
+#include <functional>
+#include <memory_resource>
+#include "HMIMemory.h"
+#include "HMIProfiler.h"
  
 using namespace std;
  
 // Singleton: Manage overall HMI state
+enum class HMIMode : uint8_t { Day, Night };
+ 
+const char* modeName(HMIMode mode) {
+    return mode == HMIMode::Night ? "Night" : "Day";
+}
+ 
+// Mode plus the number of changes published so far
+struct ModeSnapshot {
+    HMIMode mode;
+    uint64_t version;
+};
+ 
 class HMISystem {
 private:
-    static HMISystem* instance;
-    string currentMode;
+    // Mode in the low byte, version in the rest, so one atomic load is a
+    // consistent snapshot. Reads are wait-free and never allocate.
+    atomic<uint64_t> state;
  
     // Private constructor
-    HMISystem() : currentMode("Day") {}
+    HMISystem() : state(static_cast<uint64_t>(HMIMode::Day)) {}
  
 public:
     // Delete copy constructor and assignment operator
     HMISystem(const HMISystem&) = delete;
     HMISystem& operator=(const HMISystem&) = delete;
  
+    // Function-local static: initialized exactly once, even with concurrent callers
     static HMISystem* getInstance() {
-        if (instance == nullptr) {
-            instance = new HMISystem();
-        }
-        return instance;
+        static HMISystem instance;
+        return &instance;
     }
  
-    void setMode(const string& mode) {
-        currentMode = mode;
-        cout << "HMI Mode set to: " << mode << endl;
+    // Publishes the new mode with release semantics and returns its version
+    uint64_t setMode(HMIMode mode) {
+        uint64_t current = state.load(memory_order_relaxed);
+        uint64_t next;
+        do {
+            next = (((current >> 8) + 1) << 8) | static_cast<uint64_t>(mode);
+        } while (!state.compare_exchange_weak(current, next, memory_order_release, memory_order_relaxed));
+        cout << "HMI Mode set to: " << modeName(mode) << endl;
+        return next >> 8;
     }
  
-    string getMode() const {
-        return currentMode;
+    HMIMode getMode() const {
+        return snapshot().mode;
     }
-};
  
-// Initialize static member
-HMISystem* HMISystem::instance = nullptr;
+    ModeSnapshot snapshot() const {
+        uint64_t current = state.load(memory_order_acquire);
+        return {static_cast<HMIMode>(current & 0xFF), current >> 8};
+    }
+};
  
 // Factory: Create controls dynamically
 class Control {
 public:
+    int x = 0;
+    int y = 0;
+ 
     virtual void render() const = 0;
     virtual ~Control() {}
 };
  
-class Button : public Control {
+class Button final : public Control {
 public:
     void render() const override {
         cout << "Rendering Button" << endl;
     }
 };
  
-class Slider : public Control {
+class Slider final : public Control {
 public:
     void render() const override {
         cout << "Rendering Slider" << endl;
     }
 };
  
+using ControlTypeId = uint32_t;
+ 
+// Registry-based factory. Each control type registers once under a name and
+// gets a small integer ID; after that, creation is an index into the type
+// table instead of a chain of string compares.
 class ControlFactory {
 public:
-    static unique_ptr<Control> createControl(const string& type) {
-        if (type == "Button") {
-            return make_unique<Button>();
-        } else if (type == "Slider") {
-            return make_unique<Slider>();
-        } else {
-            return nullptr;
+    struct TypeInfo {
+        string name;
+        size_t size;
+        Control* (*construct)(void* storage); // placement-new into pooled storage
+        void (*destroy)(void* storage);       // runs ~T() on an object made by construct
+        size_t baseOffset;                    // of the Control base within T
+        const type_info* rtti;
+    };
+ 
+    template <typename T>
+    static ControlTypeId registerType(const string& name) {
+        static_assert(is_base_of<Control, T>::value, "registered types must derive from Control");
+        static_assert(alignof(T) <= alignof(max_align_t), "over-aligned controls are not supported");
+        auto existing = ids().find(name);
+        if (existing != ids().end()) {
+            return existing->second;
+        }
+        ControlTypeId id = static_cast<ControlTypeId>(types().size());
+        types().push_back({name, sizeof(T), [](void* storage) -> Control* { return new (storage) T(); },
+                           [](void* storage) { launder(reinterpret_cast<T*>(storage))->~T(); },
+                           baseOffsetOf<T>(), &typeid(T)});
+        ids()[name] = id;
+        return id;
+    }
+ 
+    // Interns a type name; look it up once, then reuse the ID
+    static bool typeId(const string& name, ControlTypeId& id) {
+        auto it = ids().find(name);
+        if (it == ids().end()) {
+            return false;
+        }
+        id = it->second;
+        return true;
+    }
+ 
+    static const TypeInfo& typeInfo(ControlTypeId id) { return types()[id]; }
+    static size_t typeCount() { return types().size(); }
+ 
+private:
+    template <typename T>
+    static size_t baseOffsetOf() {
+        T probe;
+        return static_cast<size_t>(reinterpret_cast<const unsigned char*>(static_cast<const Control*>(&probe)) -
+                                   reinterpret_cast<const unsigned char*>(&probe));
+    }
+
+    static vector<TypeInfo>& types() {
+        static vector<TypeInfo> registered;
+        return registered;
+    }
+ 
+    static unordered_map<string, ControlTypeId>& ids() {
+        static unordered_map<string, ControlTypeId> byName;
+        return byName;
+    }
+};
+ 
+const ControlTypeId ButtonType = ControlFactory::registerType<Button>("Button");
+const ControlTypeId SliderType = ControlFactory::registerType<Slider>("Slider");
+ 
+// Owns every control on one screen. Controls are constructed in per-type
+// pools of contiguous chunks and destroyed together when the screen is
+// cleared, so building a screen costs a handful of allocations, not one per
+// control. Chunks come from the memory resource given at construction (a
+// per-screen arena, say), so the screen's footprint can be tracked and capped.
+class ControlScreen {
+    static constexpr size_t CHUNK_CAPACITY = 256;
+ 
+    struct Chunk {
+        unsigned char* storage;
+        size_t capacity;
+        size_t used;
+    };
+ 
+    struct Pool {
+        size_t stride = 0;
+        size_t count = 0;
+        vector<Chunk> chunks;
+    };
+ 
+    pmr::memory_resource* resource;
+    vector<Pool> pools; // indexed by ControlTypeId
+    size_t controlCount = 0;
+ 
+    static size_t strideFor(size_t size) {
+        size_t align = alignof(max_align_t);
+        return (size + align - 1) / align * align;
+    }
+ 
+    // Last chunk if it has room left, else a new one sized for n more objects
+    Chunk& reserve(Pool& pool, size_t n) {
+        if (pool.chunks.empty() || pool.chunks.back().used == pool.chunks.back().capacity) {
+            size_t capacity = max(n, CHUNK_CAPACITY);
+            void* storage = resource->allocate(capacity * pool.stride, alignof(max_align_t));
+            pool.chunks.push_back({static_cast<unsigned char*>(storage), capacity, 0});
+        }
+        return pool.chunks.back();
+    }
+ 
+    Pool& poolFor(ControlTypeId type) {
+        if (type >= pools.size()) {
+            pools.resize(ControlFactory::typeCount());
+        }
+        Pool& pool = pools[type];
+        if (pool.stride == 0) {
+            pool.stride = strideFor(ControlFactory::typeInfo(type).size);
+        }
+        return pool;
+    }
+ 
+public:
+    explicit ControlScreen(pmr::memory_resource* resource = pmr::get_default_resource()) : resource(resource) {}
+    ControlScreen(const ControlScreen&) = delete;
+    ControlScreen& operator=(const ControlScreen&) = delete;
+    ~ControlScreen() { clear(); }
+ 
+    Control* create(ControlTypeId type) {
+        Pool& pool = poolFor(type);
+        Chunk& chunk = reserve(pool, 1);
+        Control* control = ControlFactory::typeInfo(type).construct(chunk.storage + chunk.used * pool.stride);
+        chunk.used++;
+        pool.count++;
+        controlCount++;
+        return control;
+    }
+ 
+    // n controls of one type: the rest of the current chunk is filled first,
+    // the remainder goes into one new chunk
+    vector<Control*> createBatch(ControlTypeId type, size_t n) {
+        vector<Control*> created;
+        created.reserve(n);
+        Pool& pool = poolFor(type);
+        auto construct = ControlFactory::typeInfo(type).construct;
+        while (created.size() < n) {
+            Chunk& chunk = reserve(pool, n - created.size());
+            size_t count = min(n - created.size(), chunk.capacity - chunk.used);
+            for (size_t i = 0; i < count; i++) {
+                created.push_back(construct(chunk.storage + chunk.used * pool.stride));
+                chunk.used++;
+                pool.count++;
+                controlCount++;
+            }
+        }
+        return created;
+    }
+ 
+    // Destroy every control on the screen at once
+    void clear() {
+        for (ControlTypeId type = 0; type < pools.size(); type++) {
+            Pool& pool = pools[type];
+            auto destroy = ControlFactory::typeInfo(type).destroy;
+            for (auto& chunk : pool.chunks) {
+                for (size_t i = 0; i < chunk.used; i++) {
+                    destroy(chunk.storage + i * pool.stride);
+                }
+                resource->deallocate(chunk.storage, chunk.capacity * pool.stride, alignof(max_align_t));
+            }
+            pool.chunks.clear();
+            pool.count = 0;
+        }
+        controlCount = 0;
+    }
+ 
+    size_t size() const { return controlCount; }
+ 
+    // Visit the controls of one concrete type in pool order, without virtual
+    // calls
+    template <typename T, typename Visitor>
+    void forEach(ControlTypeId type, Visitor visit) const {
+        if (*ControlFactory::typeInfo(type).rtti != typeid(T)) {
+            throw runtime_error("forEach: T is not the type registered as " + ControlFactory::typeInfo(type).name);
+        }
+        if (type >= pools.size()) {
+            return;
+        }
+        const Pool& pool = pools[type];
+        for (const Chunk& chunk : pool.chunks) {
+            const unsigned char* storage = chunk.storage;
+            for (size_t i = 0; i < chunk.used; i++) {
+                visit(*launder(reinterpret_cast<const T*>(storage + i * pool.stride)));
+            }
+        }
+    }
+ 
+    // Visit every control of every registered type as visit(type, control),
+    // pool by pool. The type is resolved once per pool: each control's Control
+    // base sits at the type's registered offset, so the loop is plain pointer
+    // arithmetic with no call per control and visit can be inlined.
+    // part/partCount split every pool into partCount contiguous slices and
+    // visit only slice `part`, so threads can share the screen without
+    // visiting any control twice.
+    template <typename Visitor>
+    void forEachControl(Visitor visit, size_t part = 0, size_t partCount = 1) const {
+        for (ControlTypeId type = 0; type < pools.size(); type++) {
+            const Pool& pool = pools[type];
+            size_t baseOffset = ControlFactory::typeInfo(type).baseOffset;
+            size_t first = pool.count * part / partCount;
+            size_t last = pool.count * (part + 1) / partCount;
+            size_t chunkStart = 0; // pool index of the chunk's first control
+            for (const Chunk& chunk : pool.chunks) {
+                if (chunkStart >= last) {
+                    break;
+                }
+                size_t begin = first > chunkStart ? first - chunkStart : 0;
+                size_t end = min(chunk.used, last - chunkStart);
+                const unsigned char* base = chunk.storage + baseOffset;
+                for (size_t i = begin; i < end; i++) {
+                    visit(type, *launder(reinterpret_cast<const Control*>(base + i * pool.stride)));
+                }
+                chunkStart += chunk.used;
+            }
         }
     }
 };
@@ -95,14 +344,14 @@ public:
 // Observer: Notify widgets when mode changes
 class ModeObserver {
 public:
-    virtual void update(const string& mode) = 0;
+    virtual void update(HMIMode mode) = 0;
     virtual ~ModeObserver() {}
 };
  
 class ButtonObserver : public ModeObserver {
 public:
-    void update(const string& mode) override {
-        if (mode == "Night") {
+    void update(HMIMode mode) override {
+        if (mode == HMIMode::Night) {
             cout << "Button adjusted for Night mode." << endl;
         } else {
             cout << "Button adjusted for Day mode." << endl;
@@ -112,8 +361,8 @@ public:
  
 class SliderObserver : public ModeObserver {
 public:
-    void update(const string& mode) override {
-        if (mode == "Night") {
+    void update(HMIMode mode) override {
+        if (mode == HMIMode::Night) {
             cout << "Slider adjusted for Night mode." << endl;
         } else {
             cout << "Slider adjusted for Day mode." << endl;
@@ -121,80 +370,687 @@ public:
     }
 };
  
-class HMIModeManager {
-    vector<ModeObserver*> observers;
+// Everything a widget needs to draw itself in one mode
+struct WidgetAppearance {
+    ControlTypeId type;
+    uint32_t background; // 0xRRGGBB
+    uint32_t foreground;
+    uint32_t accent;
+    uint8_t brightness;  // percent
+};
+ 
+// Full configuration of one widget type in one mode. This is the slow path
+// the cache exists to avoid repeating on every switch.
+WidgetAppearance computeAppearance(ControlTypeId type, HMIMode mode) {
+    const string& name = ControlFactory::typeInfo(type).name;
+    bool night = mode == HMIMode::Night;
+    WidgetAppearance appearance;
+    appearance.type = type;
+    appearance.background = night ? 0x101418 : 0xF4F4F4;
+    appearance.foreground = night ? 0xE0E0E0 : 0x202020;
+    if (name == "Slider") {
+        appearance.accent = night ? 0x2F6F9F : 0x3A8FD0;
+    } else {
+        appearance.accent = night ? 0x9F6F2F : 0xD08F3A;
+    }
+    appearance.brightness = night ? 40 : 100;
+    return appearance;
+}
+ 
+// One mode's configuration for every widget, indexed by widget ID
+using AppearanceTable = vector<WidgetAppearance>;
  
+struct ModeTable {
+    HMIMode mode;
+    shared_ptr<const AppearanceTable> appearances; // never modified; valid while held
+    size_t count;
+};
+ 
+// Per-mode widget configuration cache. Each mode's table is built once, the
+// first time that mode is used, and kept contiguous; after that a mode switch
+// swaps the active table pointer and hands the whole table to each listener
+// in one call instead of updating widgets one by one. Published tables are
+// immutable: adding widgets copies each built table once with the new entries
+// and swaps the copy in, so readers on other threads never see a table change
+// under them; add a screen's widgets with one addWidgets() call. Switches may
+// come from any thread (e.g. the mode bus). Listeners are called after the
+// cache's lock is released, so they may call back into the cache.
+class ModeConfigCache : public ModeObserver {
 public:
-    void addObserver(ModeObserver* observer) {
-        observers.push_back(observer);
+    using WidgetId = uint32_t;
+    using Listener = function<void(const ModeTable&)>;
+ 
+    WidgetId addWidget(ControlTypeId type) {
+        return addWidgets(&type, 1);
+    }
+ 
+    // Adds `count` widgets with consecutive IDs and returns the first one.
+    // Each built table is copied and republished once for the whole batch.
+    WidgetId addWidgets(const ControlTypeId* newTypes, size_t count) {
+        lock_guard<mutex> lock(mtx);
+        WidgetId first = static_cast<WidgetId>(types.size());
+        types.insert(types.end(), newTypes, newTypes + count);
+        for (size_t mode = 0; mode < tables.size(); mode++) {
+            if (tables[mode]) {
+                auto grown = make_shared<AppearanceTable>();
+                grown->reserve(types.size());
+                grown->assign(tables[mode]->begin(), tables[mode]->end());
+                for (size_t i = 0; i < count; i++) {
+                    grown->push_back(computeAppearance(newTypes[i], static_cast<HMIMode>(mode)));
+                }
+                tables[mode] = move(grown);
+            }
+        }
+        if (hasActive) {
+            atomic_store_explicit(&active, tables[static_cast<size_t>(activeMode)], memory_order_release);
+        }
+        return first;
+    }
+ 
+    WidgetId addWidgets(const vector<ControlTypeId>& newTypes) {
+        return addWidgets(newTypes.data(), newTypes.size());
+    }
+ 
+    void addListener(Listener listener) {
+        lock_guard<mutex> lock(mtx);
+        auto grown = make_shared<vector<Listener>>(*listeners);
+        grown->push_back(move(listener));
+        listeners = move(grown);
+    }
+ 
+    // Builds the mode's table now instead of on the first switch
+    void prepare(HMIMode mode) {
+        lock_guard<mutex> lock(mtx);
+        tableFor(mode);
     }
  
-    void notifyObservers(const string& mode) {
-        for (auto observer : observers) {
-            observer->update(mode);
+    ModeTable switchMode(HMIMode mode) {
+        ModeTable current;
+        shared_ptr<const vector<Listener>> notify;
+        {
+            lock_guard<mutex> lock(mtx);
+            const shared_ptr<const AppearanceTable>& table = tableFor(mode);
+            atomic_store_explicit(&active, table, memory_order_release);
+            activeMode = mode;
+            hasActive = true;
+            current = {mode, table, table->size()};
+            notify = listeners;
+        }
+        for (const auto& listener : *notify) {
+            listener(current);
+        }
+        return current;
+    }
+ 
+    void update(HMIMode mode) override {
+        switchMode(mode);
+    }
+ 
+    // Active configuration of one widget; switchMode() must have run once
+    WidgetAppearance appearance(WidgetId widget) const {
+        return (*atomic_load_explicit(&active, memory_order_acquire))[widget];
+    }
+ 
+    // The whole active table, for readers that go through many widgets
+    shared_ptr<const AppearanceTable> activeTable() const {
+        return atomic_load_explicit(&active, memory_order_acquire);
+    }
+ 
+    size_t widgetCount() const {
+        lock_guard<mutex> lock(mtx);
+        return types.size();
+    }
+ 
+private:
+    mutable mutex mtx;
+    vector<ControlTypeId> types;
+    array<shared_ptr<const AppearanceTable>, 2> tables; // null until first used
+    shared_ptr<const AppearanceTable> active;          // accessed with atomic_load/atomic_store
+    HMIMode activeMode = HMIMode::Day;
+    bool hasActive = false;
+    shared_ptr<const vector<Listener>> listeners = make_shared<vector<Listener>>(); // copy-on-write
+ 
+    const shared_ptr<const AppearanceTable>& tableFor(HMIMode mode) {
+        size_t index = static_cast<size_t>(mode);
+        if (!tables[index]) {
+            HMI_PROFILE_SCOPE("ModeConfigCache::build");
+            auto table = make_shared<AppearanceTable>();
+            table->reserve(types.size());
+            for (ControlTypeId type : types) {
+                table->push_back(computeAppearance(type, mode));
+            }
+            tables[index] = move(table);
+        }
+        return tables[index];
+    }
+};
+ 
+// Asynchronous notification bus. notifyObservers() only records the new mode
+// and wakes a worker; the worker fans the change out by queueing observers
+// that are not already queued, and the workers deliver the latest mode,
+// higher priority first. Changes that arrive before an observer is reached
+// are coalesced, each observer is updated by one worker at a time, and
+// observers are held weakly: a removed observer is skipped and an expired
+// one is dropped from the list during the next fan-out. The subscriber list
+// is copy-on-write, so a fan-out walks it without holding the lock.
+class HMIModeManager {
+public:
+    using ObserverHandle = uint64_t;
+ 
+    explicit HMIModeManager(unsigned workerCount = thread::hardware_concurrency()) {
+        for (unsigned i = 0; i < max(workerCount, 1u); i++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+ 
+    ~HMIModeManager() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+ 
+    ObserverHandle addObserver(const shared_ptr<ModeObserver>& observer, int priority = 0) {
+        auto subscription = make_shared<Subscription>();
+        subscription->observer = observer;
+        subscription->priority = priority;
+        lock_guard<mutex> lock(mtx);
+        subscription->handle = nextHandle++;
+        writableSubscriptions().push_back(subscription);
+        return subscription->handle;
+    }
+ 
+    void removeObserver(ObserverHandle handle) {
+        lock_guard<mutex> lock(mtx);
+        SubscriptionList& list = writableSubscriptions();
+        auto it = find_if(list.begin(), list.end(),
+                          [handle](const shared_ptr<Subscription>& s) { return s->handle == handle; });
+        if (it != list.end()) {
+            (*it)->removed = true;
+            list.erase(it);
+        }
+    }
+ 
+    // Never waits for observers and does not depend on how many there are
+    void notifyObservers(HMIMode mode) {
+        {
+            lock_guard<mutex> lock(mtx);
+            latestMode = mode;
+            generation++;
+            fanOutPending = true;
+        }
+        workAvailable.notify_one();
+    }
+ 
+    // Block until every queued delivery has finished
+    void flush() {
+        unique_lock<mutex> lock(mtx);
+        idle.wait(lock, [this] { return !fanOutPending && jobs.empty() && busyWorkers == 0; });
+    }
+ 
+private:
+    struct Subscription {
+        ObserverHandle handle = 0;
+        weak_ptr<ModeObserver> observer;
+        int priority = 0;
+        uint64_t deliveredGeneration = 0;
+        bool scheduled = false; // queued or being delivered
+        bool removed = false;
+    };
+ 
+    using SubscriptionList = vector<shared_ptr<Subscription>>;
+ 
+    struct Job {
+        int priority;
+        uint64_t sequence;
+        shared_ptr<Subscription> subscription;
+ 
+        // Higher priority first, then FIFO
+        bool operator<(const Job& other) const {
+            if (priority != other.priority) return priority < other.priority;
+            return sequence > other.sequence;
+        }
+    };
+ 
+    mutex mtx;
+    condition_variable workAvailable;
+    condition_variable idle;
+    vector<thread> workers;
+    shared_ptr<SubscriptionList> subscriptions = make_shared<SubscriptionList>(); // copy-on-write
+    priority_queue<Job> jobs;
+    HMIMode latestMode = HMIMode::Day;
+    uint64_t generation = 0;
+    uint64_t jobSequence = 0;
+    ObserverHandle nextHandle = 1;
+    unsigned busyWorkers = 0;
+    bool fanOutPending = false;
+    bool stopping = false;
+ 
+    // The list to modify, copied first if a fan-out is still reading it.
+    // Call with mtx held.
+    SubscriptionList& writableSubscriptions() {
+        if (subscriptions.use_count() > 1) {
+            subscriptions = make_shared<SubscriptionList>(*subscriptions);
+        }
+        return *subscriptions;
+    }
+ 
+    // Queue every live observer that is not already queued; called with
+    // `lock` held, walks the list without it
+    void fanOut(unique_lock<mutex>& lock) {
+        shared_ptr<const SubscriptionList> list = subscriptions;
+        lock.unlock();
+        SubscriptionList live;
+        live.reserve(list->size());
+        bool anyExpired = false;
+        for (const auto& subscription : *list) {
+            if (subscription->observer.expired()) {
+                anyExpired = true;
+            } else {
+                live.push_back(subscription);
+            }
+        }
+        list.reset();
+        lock.lock();
+ 
+        for (auto& subscription : live) {
+            if (!subscription->scheduled && !subscription->removed) {
+                subscription->scheduled = true;
+                jobs.push({subscription->priority, jobSequence++, move(subscription)});
+            }
+        }
+        if (anyExpired) {
+            SubscriptionList& current = writableSubscriptions();
+            current.erase(remove_if(current.begin(), current.end(),
+                                    [](const shared_ptr<Subscription>& s) { return s->observer.expired(); }),
+                          current.end());
+        }
+        workAvailable.notify_all();
+    }
+ 
+    void workerLoop() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            workAvailable.wait(lock, [this] { return stopping || fanOutPending || !jobs.empty(); });
+            if (fanOutPending) {
+                fanOutPending = false;
+                busyWorkers++;
+                fanOut(lock);
+                busyWorkers--;
+                notifyIfIdle();
+                continue;
+            }
+            if (jobs.empty()) {
+                return;
+            }
+            shared_ptr<Subscription> subscription = jobs.top().subscription;
+            jobs.pop();
+            busyWorkers++;
+ 
+            // Keep delivering until the observer has seen the latest mode
+            while (!subscription->removed && subscription->deliveredGeneration < generation) {
+                HMIMode mode = latestMode;
+                uint64_t target = generation;
+                shared_ptr<ModeObserver> observer = subscription->observer.lock();
+                if (!observer) {
+                    break;
+                }
+                lock.unlock();
+                observer->update(mode);
+                observer.reset();
+                lock.lock();
+                subscription->deliveredGeneration = target;
+            }
+            subscription->scheduled = false;
+ 
+            busyWorkers--;
+            notifyIfIdle();
+        }
+    }
+ 
+    void notifyIfIdle() {
+        if (!fanOutPending && jobs.empty() && busyWorkers == 0) {
+            idle.notify_all();
         }
     }
 };
  
 // Strategy: Define rendering behaviors
+ 
+// Strategy-independent draw command recorded for one control
+struct DrawCommand {
+    ControlTypeId type;
+    int x;
+    int y;
+ 
+    // Group by control type (render state), then by screen position
+    bool operator<(const DrawCommand& other) const {
+        if (type != other.type) return type < other.type;
+        if (y != other.y) return y < other.y;
+        return x < other.x;
+    }
+};
+ 
 class RenderingStrategy {
 public:
     virtual void render() const = 0;
+    // Per-object path: append one control's vertex data
+    virtual void project(const Control& control, vector<float>& vertices) const = 0;
+    // Command-buffer path: one virtual call for a whole recorded frame
+    virtual void submit(const vector<DrawCommand>& commands, vector<float>& vertices) const = 0;
     virtual ~RenderingStrategy() {}
 };
  
-class Render2D : public RenderingStrategy {
+class Render2D final : public RenderingStrategy {
 public:
     void render() const override {
         cout << "Rendering in 2D mode." << endl;
     }
+ 
+    void project(const Control& control, vector<float>& vertices) const override {
+        emit(control.x, control.y, vertices);
+    }
+ 
+    void submit(const vector<DrawCommand>& commands, vector<float>& vertices) const override {
+        for (const auto& command : commands) {
+            emit(command.x, command.y, vertices);
+        }
+    }
+ 
+    void emit(int x, int y, vector<float>& vertices) const {
+        vertices.push_back(static_cast<float>(x));
+        vertices.push_back(static_cast<float>(y));
+    }
 };
  
-class Render3D : public RenderingStrategy {
+class Render3D final : public RenderingStrategy {
 public:
     void render() const override {
         cout << "Rendering in 3D mode." << endl;
     }
+ 
+    void project(const Control& control, vector<float>& vertices) const override {
+        emit(control.x, control.y, vertices);
+    }
+ 
+    void submit(const vector<DrawCommand>& commands, vector<float>& vertices) const override {
+        for (const auto& command : commands) {
+            emit(command.x, command.y, vertices);
+        }
+    }
+ 
+    void emit(int x, int y, vector<float>& vertices) const {
+        vertices.push_back(static_cast<float>(x));
+        vertices.push_back(static_cast<float>(y));
+        vertices.push_back(0.0f);
+    }
 };
  
+// Records draw commands into a command buffer, then submits the buffer through
+// the current strategy. The screen is split into horizontal bands, one per
+// worker; the workers are started once and reused for every frame. A frame is
+// recorded in two phases: each worker walks its own slice of every pool once
+// and drops each command into a bucket for its band, then each worker gathers
+// its band's buckets into one linear buffer and sorts it. Buffers are reused
+// between frames. Switching strategy only needs another submit(), not another
+// record().
 class HMIRenderer {
+    enum class Phase { Scatter, Gather };
+ 
     RenderingStrategy* strategy;
+    int screenHeight;
+    vector<vector<vector<DrawCommand>>> bandBuckets; // [worker][band]
+    vector<vector<DrawCommand>> threadBuffers;       // [band]
+    vector<vector<size_t>> bandOffsets;              // [band], counting-sort scratch
+    vector<DrawCommand> commands;
+ 
+    // Recording workers; runPhase() publishes work by bumping `frame`
+    mutex workMtx;
+    condition_variable frameReady;
+    condition_variable frameDone;
+    vector<thread> workers;
+    const ControlScreen* frameScreen = nullptr;
+    Phase framePhase = Phase::Scatter;
+    uint64_t frame = 0;
+    unsigned pendingWorkers = 0;
+    bool stopping = false;
+ 
+    unsigned regionOf(int y, unsigned regionCount) const {
+        if (y <= 0) return 0;
+        int64_t region = static_cast<int64_t>(y) * regionCount / screenHeight;
+        return static_cast<unsigned>(min<int64_t>(region, regionCount - 1));
+    }
+ 
+    // Phase 1: this worker's slice of the screen, bucketed by band
+    void scatter(const ControlScreen& screen, unsigned worker, unsigned workerCount) {
+        HMI_PROFILE_SCOPE("HMIRenderer::record/scatter");
+        vector<vector<DrawCommand>>& buckets = bandBuckets[worker];
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        screen.forEachControl([&](ControlTypeId type, const Control& control) {
+            buckets[regionOf(control.y, workerCount)].push_back({type, control.x, control.y});
+        }, worker, workerCount);
+    }
+ 
+    // First row of a band: the smallest y with regionOf(y) == band
+    int bandTop(unsigned band, unsigned bandCount) const {
+        return static_cast<int>((static_cast<int64_t>(band) * screenHeight + bandCount - 1) / bandCount);
+    }
+ 
+    // Phase 2: every worker's bucket for this band, sorted. A band spans few
+    // rows, so the commands are counting-sorted by (type, row) straight into
+    // the band's buffer; only the commands within one row (or off screen,
+    // clamped to the band's first or last row) are then sorted by x.
+    void gather(unsigned band, unsigned bandCount) {
+        HMI_PROFILE_SCOPE("HMIRenderer::record/gather");
+        int top = bandTop(band, bandCount);
+        size_t rows = static_cast<size_t>(max(bandTop(band + 1, bandCount) - top, 1));
+        auto keyOf = [&](const DrawCommand& command) {
+            int64_t row = min<int64_t>(max<int64_t>(static_cast<int64_t>(command.y) - top, 0), rows - 1);
+            return command.type * rows + static_cast<size_t>(row);
+        };
+ 
+        vector<size_t>& offsets = bandOffsets[band];
+        offsets.assign(ControlFactory::typeCount() * rows + 1, 0);
+        for (const auto& buckets : bandBuckets) {
+            for (const DrawCommand& command : buckets[band]) {
+                offsets[keyOf(command) + 1]++;
+            }
+        }
+        for (size_t key = 1; key < offsets.size(); key++) {
+            offsets[key] += offsets[key - 1];
+        }
+        vector<DrawCommand>& buffer = threadBuffers[band];
+        buffer.resize(offsets.back());
+        for (const auto& buckets : bandBuckets) {
+            for (const DrawCommand& command : buckets[band]) {
+                buffer[offsets[keyOf(command)]++] = command;
+            }
+        }
+        // offsets[key] is now the end of key's group
+        size_t begin = 0;
+        for (size_t key = 0; key + 1 < offsets.size(); key++) {
+            auto first = buffer.begin() + begin, last = buffer.begin() + offsets[key];
+            if (!is_sorted(first, last)) {
+                sort(first, last);
+            }
+            begin = offsets[key];
+        }
+    }
+ 
+    void runPhase(Phase phase, const ControlScreen& screen) {
+        unique_lock<mutex> lock(workMtx);
+        frameScreen = &screen;
+        framePhase = phase;
+        pendingWorkers = static_cast<unsigned>(workers.size());
+        frame++;
+        frameReady.notify_all();
+        frameDone.wait(lock, [this] { return pendingWorkers == 0; });
+    }
+ 
+    // `recorded` is the last frame published before the worker was started
+    void workerLoop(unsigned worker, unsigned workerCount, uint64_t recorded) {
+        unique_lock<mutex> lock(workMtx);
+        while (true) {
+            frameReady.wait(lock, [&] { return stopping || frame != recorded; });
+            if (stopping) {
+                return;
+            }
+            recorded = frame;
+            const ControlScreen* screen = frameScreen;
+            Phase phase = framePhase;
+            lock.unlock();
+            if (phase == Phase::Scatter) {
+                scatter(*screen, worker, workerCount);
+            } else {
+                gather(worker, workerCount);
+            }
+            lock.lock();
+            if (--pendingWorkers == 0) {
+                frameDone.notify_one();
+            }
+        }
+    }
+ 
+    void stopWorkers() {
+        {
+            lock_guard<mutex> lock(workMtx);
+            stopping = true;
+        }
+        frameReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        stopping = false;
+    }
+ 
+    void startWorkers(unsigned count) {
+        stopWorkers();
+        threadBuffers.assign(count, {});
+        bandOffsets.assign(count, {});
+        bandBuckets.assign(count, vector<vector<DrawCommand>>(count));
+        uint64_t published = frame;
+        for (unsigned worker = 0; worker < count; worker++) {
+            workers.emplace_back([this, worker, count, published] { workerLoop(worker, count, published); });
+        }
+    }
  
 public:
-    HMIRenderer(RenderingStrategy* initialStrategy) : strategy(initialStrategy) {}
+    explicit HMIRenderer(RenderingStrategy* initialStrategy, int screenHeight = 720)
+        : strategy(initialStrategy), screenHeight(max(screenHeight, 1)) {}
+ 
+    HMIRenderer(const HMIRenderer&) = delete;
+    HMIRenderer& operator=(const HMIRenderer&) = delete;
+    ~HMIRenderer() { stopWorkers(); }
  
     void setStrategy(RenderingStrategy* newStrategy) {
         strategy = newStrategy;
     }
  
     void render() const {
+        HMI_PROFILE_SCOPE("HMIRenderer::render");
         strategy->render();
     }
+ 
+    // Record the whole screen in threadCount bands and sort the result by
+    // render state. The workers are restarted only if threadCount changes.
+    // Each band is sorted by its worker; bands cover increasing y, so taking
+    // every band's commands of one type in band order keeps the sort order.
+    void record(const ControlScreen& screen, unsigned threadCount) {
+        HMI_PROFILE_SCOPE("HMIRenderer::record");
+        threadCount = max(threadCount, 1u);
+        if (threadCount != workers.size()) {
+            startWorkers(threadCount);
+        }
+        runPhase(Phase::Scatter, screen);
+        runPhase(Phase::Gather, screen);
+ 
+        commands.clear();
+        vector<size_t> next(threadBuffers.size(), 0);
+        for (ControlTypeId type = 0; type < ControlFactory::typeCount(); type++) {
+            for (size_t band = 0; band < threadBuffers.size(); band++) {
+                const vector<DrawCommand>& buffer = threadBuffers[band];
+                size_t end = next[band];
+                while (end < buffer.size() && buffer[end].type == type) {
+                    end++;
+                }
+                commands.insert(commands.end(), buffer.begin() + next[band], buffer.begin() + end);
+                next[band] = end;
+            }
+        }
+    }
+ 
+    void submit(vector<float>& vertices) const {
+        HMI_PROFILE_SCOPE("HMIRenderer::submit");
+        strategy->submit(commands, vertices);
+    }
+ 
+    size_t commandCount() const { return commands.size(); }
 };
  
+// Data-oriented render path: the strategy is resolved once per batch through
+// std::visit, then the pool of every registered control type is walked
+// contiguously, with an inlinable emit instead of two virtual calls per control.
+using RenderStrategyVariant = variant<Render2D, Render3D>;
+ 
+void renderBatch(const ControlScreen& screen, const RenderStrategyVariant& strategy, vector<float>& vertices) {
+    visit([&](const auto& selected) {
+        screen.forEachControl([&](ControlTypeId, const Control& control) { selected.emit(control.x, control.y, vertices); });
+    }, strategy);
+}
+ 
 // Main: Combining all patterns
+#ifndef HMI_NO_MAIN
 int main() {
     // Singleton: Manage HMI mode
     HMISystem* hmiSystem = HMISystem::getInstance();
-    hmiSystem->setMode("Day");
+    hmiSystem->setMode(HMIMode::Day);
  
-    // Factory: Create controls
-    auto button = ControlFactory::createControl("Button");
-    auto slider = ControlFactory::createControl("Slider");
+    // Factory: Create controls, stored in the screen's arena
+    hmimem::FrameArena screenArena("screen");
+    ControlScreen screen(&screenArena);
+    Control* button = screen.create(ButtonType);
+    Control* slider = screen.create(SliderType);
     button->render();
     slider->render();
  
+    ControlTypeId sliderType;
+    if (ControlFactory::typeId("Slider", sliderType)) {
+        screen.createBatch(ButtonType, 500);
+        screen.createBatch(sliderType, 500);
+    }
+    cout << "Screen holds " << screen.size() << " pooled controls." << endl;
+ 
     // Observer: Notify widgets about mode change
-    ButtonObserver buttonObserver;
-    SliderObserver sliderObserver;
+    auto buttonObserver = make_shared<ButtonObserver>();
+    auto sliderObserver = make_shared<SliderObserver>();
+ 
+    HMIModeManager modeManager(1);
+    modeManager.addObserver(buttonObserver, 1);
+    modeManager.addObserver(sliderObserver);
  
-    HMIModeManager modeManager;
-    modeManager.addObserver(&buttonObserver);
-    modeManager.addObserver(&sliderObserver);
+    // Widget configurations for both modes, switched as one table; one widget
+    // per control on the screen, in the screen's visiting order
+    auto configCache = make_shared<ModeConfigCache>();
+    vector<ControlTypeId> widgetTypes;
+    widgetTypes.reserve(screen.size());
+    screen.forEachControl([&](ControlTypeId type, const Control&) { widgetTypes.push_back(type); });
+    configCache->addWidgets(widgetTypes);
+    configCache->addListener([](const ModeTable& table) {
+        cout << "Widget table switched to " << modeName(table.mode) << " mode for " << table.count << " widgets." << endl;
+    });
+    modeManager.addObserver(configCache, 2);
  
     // Change to Night mode and notify observers
-    hmiSystem->setMode("Night");
+    hmiSystem->setMode(HMIMode::Night);
     modeManager.notifyObservers(hmiSystem->getMode());
+    modeManager.flush();
  
     // Strategy: Switch rendering behaviors
     Render2D render2D;
@@ -206,5 +1062,25 @@ int main() {
     renderer.setStrategy(&render3D);
     renderer.render();
  
+    // Batch render every pooled control with the 3D strategy
+    vector<float> vertices;
+    vertices.reserve(screen.size() * 3);
+    renderBatch(screen, render3D, vertices);
+    cout << "Batch-rendered " << screen.size() << " controls into " << vertices.size() << " vertex values." << endl;
+ 
+    // Record once, then submit the same command buffer with each strategy
+    renderer.record(screen, 4);
+    vertices.clear();
+    renderer.submit(vertices);
+    cout << "Submitted " << renderer.commandCount() << " commands in 3D: " << vertices.size() << " vertex values." << endl;
+ 
+    renderer.setStrategy(&render2D);
+    vertices.clear();
+    renderer.submit(vertices);
+    cout << "Re-submitted " << renderer.commandCount() << " commands in 2D: " << vertices.size() << " vertex values." << endl;
+ 
+    hmimem::report(cout);
+    HMI_PROFILE_REPORT("prgm9_trace.json");
     return 0;
 }
+#endif
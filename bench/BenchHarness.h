@@ -0,0 +1,132 @@
+/* Micro-benchmark harness
+Shared by the bench_prgmN programs. Each benchmark runs once per data size
+and reports one JSON object per line on stdout, so runs can be collected
+into a file and compared over time:
+
+    {"benchmark":"prgm8/std_sort","size":100000,"repetitions":5,"min_ns":...,"median_ns":...,"ns_per_item":...}
+
+Command line (every bench_prgmN accepts the same options):
+    --sizes=1000,100000   data sizes to run (default: per-benchmark list)
+    --reps=5              timed repetitions per size (median and min reported)
+    --filter=text         only run benchmarks whose name contains text
+*/
+
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Options {
+    std::vector<size_t> sizes; // empty: use the benchmark's defaults
+    int repetitions = 5;
+    std::string filter;
+};
+
+inline Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--sizes=", 0) == 0) {
+            std::stringstream list(arg.substr(8));
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                options.sizes.push_back(static_cast<size_t>(std::strtoull(item.c_str(), nullptr, 10)));
+            }
+        } else if (arg.rfind("--reps=", 0) == 0) {
+            options.repetitions = std::max(1, std::atoi(arg.c_str() + 7));
+        } else if (arg.rfind("--filter=", 0) == 0) {
+            options.filter = arg.substr(9);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--sizes=n1,n2,...] [--reps=n] [--filter=text]" << std::endl;
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+// Stops the compiler from discarding a computed value
+template <typename T>
+inline void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Discards everything the code under test writes to std::cout
+class SilenceCout {
+    struct NullBuffer : std::streambuf {
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    NullBuffer nullBuffer;
+    std::streambuf* saved;
+
+public:
+    SilenceCout() : saved(std::cout.rdbuf(&nullBuffer)) {}
+    ~SilenceCout() { std::cout.rdbuf(saved); }
+    SilenceCout(const SilenceCout&) = delete;
+    SilenceCout& operator=(const SilenceCout&) = delete;
+};
+
+inline std::vector<size_t> sizesFor(const Options& options, const std::vector<size_t>& defaults) {
+    return options.sizes.empty() ? defaults : options.sizes;
+}
+
+inline void report(const std::string& name, size_t size, int repetitions, std::vector<uint64_t> timesNs) {
+    std::sort(timesNs.begin(), timesNs.end());
+    uint64_t median = timesNs[timesNs.size() / 2];
+    std::printf("{\"benchmark\":\"%s\",\"size\":%zu,\"repetitions\":%d,\"min_ns\":%llu,\"median_ns\":%llu,"
+                "\"ns_per_item\":%.3f}\n",
+                name.c_str(), size, repetitions, static_cast<unsigned long long>(timesNs.front()),
+                static_cast<unsigned long long>(median), size ? static_cast<double>(median) / size : 0.0);
+    std::fflush(stdout);
+}
+
+// Times body(state) once per repetition; setup() builds a fresh state
+// outside the timed region. std::cout is silenced while timing.
+template <typename Setup, typename Body>
+void run(const Options& options, const std::string& name, size_t size, Setup setup, Body body) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+        return;
+    }
+    std::vector<uint64_t> timesNs;
+    for (int rep = 0; rep < options.repetitions; rep++) {
+        auto state = setup();
+        uint64_t elapsed;
+        {
+            SilenceCout silence;
+            auto start = std::chrono::steady_clock::now();
+            body(state);
+            elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+        keep(state);
+        timesNs.push_back(elapsed);
+    }
+    report(name, size, options.repetitions, timesNs);
+}
+
+// Benchmark without per-repetition setup
+template <typename Body>
+void run(const Options& options, const std::string& name, size_t size, Body body) {
+    run(options, name, size, [] { return 0; }, [&body](int&) { body(); });
+}
+
+} // namespace bench
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,77 @@
+// Menu navigation benchmarks (Prgm1)
+#define HMI_NO_MAIN
+#include "Prgm1.cpp"
+#include "BenchHarness.h"
+
+#include <string>
+
+// Root with `size` leaf children, laid out like a menuTable but built at
+// runtime so the size can be chosen on the command line
+struct FlatMenu {
+    vector<string> labels;
+    vector<menuNode> nodes;
+    vector<uint32_t> childSlots;
+
+    explicit FlatMenu(size_t size) {
+        labels.push_back("Main menu");
+        for (size_t i = 0; i < size; i++) {
+            labels.push_back("Item " + to_string(i));
+        }
+        nodes.push_back({labels[0].c_str(), static_cast<uint32_t>(size + 1), static_cast<uint32_t>(size), 0, noList});
+        for (size_t i = 1; i <= size; i++) {
+            nodes.push_back({labels[i].c_str(), 1, 0, static_cast<uint32_t>(size), noList});
+            childSlots.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    menuView view() const { return {nodes.data(), childSlots.data()}; }
+};
+
+// Backing list of `size` generated labels, as a media library would supply
+class GeneratedList : public menuProvider {
+    uint32_t count;
+
+public:
+    explicit GeneratedList(size_t count) : count(static_cast<uint32_t>(count)) {}
+    uint32_t size() const override { return count; }
+    string label(uint32_t index) const override { return "Item " + to_string(index); }
+};
+
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+
+    // Startup with the static table: independent of menu size
+    bench::run(options, "prgm1/static_menu_startup", 1, [] { bench::keep(viewOf(mainMenu)); });
+
+    for (size_t size : bench::sizesFor(options, {10, 1000, 100000})) {
+        FlatMenu flat(size);
+        menuView menu = flat.view();
+
+        bench::run(options, "prgm1/displayMenu", size, [&menu] { displayMenu(menu, 0); });
+
+        bench::run(options, "prgm1/select_child", size, [&menu, size] {
+            size_t total = 0;
+            for (uint32_t choice = 1; choice <= size; choice++) {
+                total += menu.childCount(menu.child(0, choice - 1));
+            }
+            bench::keep(total);
+        });
+
+        // Virtualized list: cost per page is independent of the list size
+        GeneratedList provider(size);
+        bench::run(options, "prgm1/virtual_list_first_page", size, [&provider] {
+            virtualList entries(provider);
+            entries.render();
+        });
+
+        bench::run(options, "prgm1/virtual_list_scroll_100_pages", size, [&provider] {
+            virtualList entries(provider);
+            for (int page = 0; page < 100; page++) {
+                entries.render();
+                entries.scrollBy(entries.pageSize());
+            }
+            bench::keep(entries.labelsLoaded());
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Telemetry update and display benchmarks (Prgm2)
+#define HMI_NO_MAIN
+#include "Prgm2.cpp"
+#include "BenchHarness.h"
+
+#ifdef HMI_HAS_SHARED_MEMORY
+#include <sys/socket.h>
+
+// Ping-pong `rounds` samples between two threads and return when done. Each
+// side waits for the other's sample before sending the next, so the time per
+// round is one round-trip latency.
+void shmPingPong(size_t rounds)
+{
+    TelemetryBus::remove("/bench_prgm2_ping");
+    TelemetryBus::remove("/bench_prgm2_pong");
+    TelemetryBus pingWriter("/bench_prgm2_ping", TelemetryBus::Writer);
+    TelemetryBus pongWriter("/bench_prgm2_pong", TelemetryBus::Writer);
+    TelemetryBus pingReader("/bench_prgm2_ping", TelemetryBus::Reader);
+    TelemetryBus pongReader("/bench_prgm2_pong", TelemetryBus::Reader);
+
+    auto waitFor = [](const TelemetryBus& bus, uint64_t number) {
+        TelemetrySample sample;
+        while (!bus.readLatest(sample) || sample.number < number)
+        {
+            this_thread::yield();
+        }
+    };
+
+    VehicleData vehicle;
+    thread echo([&] {
+        for (uint64_t i = 1; i <= rounds; i++)
+        {
+            waitFor(pingReader, i);
+            pongWriter.publish(vehicle);
+        }
+    });
+    for (uint64_t i = 1; i <= rounds; i++)
+    {
+        pingWriter.publish(vehicle);
+        waitFor(pongReader, i);
+    }
+    echo.join();
+    TelemetryBus::remove("/bench_prgm2_ping");
+    TelemetryBus::remove("/bench_prgm2_pong");
+}
+
+// Same exchange through a pair of kernel byte channels (pipes or sockets)
+void fdPingPong(size_t rounds, int pingFds[2], int pongFds[2])
+{
+    thread echo([&] {
+        TelemetrySample sample;
+        for (size_t i = 0; i < rounds; i++)
+        {
+            if (read(pingFds[0], &sample, sizeof(sample)) != sizeof(sample) ||
+                write(pongFds[1], &sample, sizeof(sample)) != sizeof(sample))
+            {
+                return;
+            }
+        }
+    });
+    TelemetrySample sample{};
+    for (size_t i = 0; i < rounds; i++)
+    {
+        if (write(pingFds[1], &sample, sizeof(sample)) != sizeof(sample) ||
+            read(pongFds[0], &sample, sizeof(sample)) != sizeof(sample))
+        {
+            break;
+        }
+    }
+    echo.join();
+    for (int fd : {pingFds[0], pingFds[1], pongFds[0], pongFds[1]})
+    {
+        close(fd);
+    }
+}
+#endif
+
+// Vehicle updates per second for one fleet size and thread count, from the
+// median of `repetitions` runs of FLEET_STEPS steps
+const size_t FLEET_STEPS = 10;
+
+void reportFleetThroughput(const bench::Options& options, size_t vehicles, unsigned threads)
+{
+    string name = "prgm2/fleet_updates_per_s";
+    if (!options.filter.empty() && name.find(options.filter) == string::npos)
+    {
+        return;
+    }
+    FleetSimulation fleet(vehicles, threads);
+    fleet.step();   // warm up: first touch of the chunks, threads started
+    vector<double> seconds;
+    for (int rep = 0; rep < options.repetitions; rep++)
+    {
+        auto start = chrono::steady_clock::now();
+        fleet.run(FLEET_STEPS);
+        seconds.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    sort(seconds.begin(), seconds.end());
+    double median = seconds[seconds.size() / 2];
+    printf("{\"benchmark\":\"%s\",\"size\":%zu,\"threads\":%u,\"steps\":%zu,\"vehicle_updates_per_s\":%.0f}\n",
+           name.c_str(), vehicles, fleet.threads(), FLEET_STEPS, median > 0 ? vehicles * FLEET_STEPS / median : 0.0);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+
+    for (size_t size : bench::sizesFor(options, {1000, 100000})) {
+        bench::run(options, "prgm2/updatevehicleData", size, [size] {
+            VehicleData vehicle;
+            for (size_t i = 0; i < size; i++) {
+                vehicle.updatevehicleData();
+            }
+            bench::keep(vehicle);
+        });
+
+        bench::run(options, "prgm2/showVehicleData", size, [size] {
+            VehicleData vehicle;
+            vehicle.enginetemperature = 105; // exercise the warning path
+            Display display;
+            for (size_t i = 0; i < size; i++) {
+                display.showVehicleData(vehicle);
+            }
+        });
+
+#ifdef HMI_HAS_SHARED_MEMORY
+        // Round-trip latency between two threads: shared memory vs pipes vs sockets
+        bench::run(options, "prgm2/shm_ping_pong", size, [size] { shmPingPong(size); });
+        bench::run(options, "prgm2/pipe_ping_pong", size, [size] {
+            int ping[2], pong[2];
+            if (pipe(ping) == 0 && pipe(pong) == 0)
+            {
+                fdPingPong(size, ping, pong);
+            }
+        });
+        bench::run(options, "prgm2/socketpair_ping_pong", size, [size] {
+            int ping[2], pong[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, ping) == 0 && socketpair(AF_UNIX, SOCK_STREAM, 0, pong) == 0)
+            {
+                // each socket is bidirectional; use [0] for reading and [1] for writing as with pipes
+                fdPingPong(size, ping, pong);
+            }
+        });
+#endif
+
+        // Fleet engine: one step over all vehicles, then scaling across threads
+        bench::run(options, "prgm2/fleet_step", size, [size] { return make_unique<FleetSimulation>(size, 1); },
+                   [](unique_ptr<FleetSimulation>& fleet) { fleet->step(); });
+        unsigned hardwareThreads = max(1u, thread::hardware_concurrency());
+        for (unsigned threads = 1; threads < hardwareThreads; threads *= 2)
+        {
+            reportFleetThroughput(options, size, threads);
+        }
+        reportFleetThroughput(options, size, hardwareThreads);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Touch event dispatch benchmarks (Prgm3)
+#define HMI_NO_MAIN
+#include "Prgm3.cpp"
+#include "BenchHarness.h"
+
+#include <cstdio>
+
+// 10x overload on a virtual clock: one event arrives every microsecond and
+// handling one takes 10 us (2 us when degraded). 5% are high-priority taps,
+// 25% normal swipes and 70% low-priority events.
+const chrono::microseconds ARRIVAL_GAP(1);
+const chrono::microseconds SERVICE_TIME(10);
+const chrono::microseconds DEGRADED_SERVICE_TIME(2);
+
+eventPriority overloadPriority(size_t i) {
+    size_t bucket = i % 20;
+    return bucket == 0 ? High : bucket < 6 ? Normal : Low;
+}
+
+// Returns the scheduler so its per-class delays can be reported
+EventScheduler simulateOverload(size_t arrivals) {
+    EventScheduler scheduler;
+    eventClock::time_point now{};
+    eventClock::time_point busyUntil = now;
+    scheduledEvent next{Event(Tap, 0, 0, ""), High, {}, {}, false};
+    for (size_t i = 0; i < arrivals || scheduler.size() > 0; i++) {
+        now = eventClock::time_point{} + ARRIVAL_GAP * i;
+        if (i < arrivals) {
+            eventPriority priority = overloadPriority(i);
+            scheduler.push(Event(priority == High ? Tap : Swipe, 0, 0, ""), priority, now);
+        }
+        if (now >= busyUntil && scheduler.pop(next, now)) {
+            busyUntil = now + (next.degraded ? DEGRADED_SERVICE_TIME : SERVICE_TIME);
+        }
+    }
+    return scheduler;
+}
+
+// Same arrivals through the original FIFO queue; returns the high-priority stats
+classStats simulateOverloadFifo(size_t arrivals) {
+    queue<pair<eventClock::time_point, eventPriority>> fifo;
+    classStats high;
+    eventClock::time_point busyUntil{};
+    for (size_t i = 0; i < arrivals || !fifo.empty(); i++) {
+        eventClock::time_point now = eventClock::time_point{} + ARRIVAL_GAP * i;
+        if (i < arrivals) {
+            fifo.push({now, overloadPriority(i)});
+        }
+        if (now >= busyUntil && !fifo.empty()) {
+            if (fifo.front().second == High) {
+                high.delivered++;
+                high.recordDelay(static_cast<uint64_t>(
+                    chrono::duration_cast<chrono::nanoseconds>(now - fifo.front().first).count()));
+            }
+            fifo.pop();
+            busyUntil = now + SERVICE_TIME;
+        }
+    }
+    return high;
+}
+
+#ifdef HMI_HAS_COROUTINES
+// Handler that animates over several frames
+handlerTask animate(EventLoop& loop, int frames) {
+    for (int frame = 0; frame < frames; frame++) {
+        co_await loop.sleep(chrono::milliseconds(16));
+    }
+}
+
+// Handler that waits for a confirming tap
+handlerTask confirm(EventLoop& loop, size_t& confirmed) {
+    optional<Event> reply = co_await loop.nextEvent(Tap, chrono::seconds(2));
+    confirmed += reply ? 1 : 0;
+}
+#endif
+
+void reportDelays(const string& name, size_t size, const classStats& stats) {
+    std::printf("{\"benchmark\":\"%s\",\"size\":%zu,\"delivered\":%zu,\"degraded\":%zu,\"dropped\":%zu,"
+                "\"p50_delay_ns\":%llu,\"p99_delay_ns\":%llu,\"max_delay_ns\":%llu}\n",
+                name.c_str(), size, stats.delivered, stats.degraded, stats.dropped,
+                static_cast<unsigned long long>(stats.delayPercentileNs(50)),
+                static_cast<unsigned long long>(stats.delayPercentileNs(99)),
+                static_cast<unsigned long long>(stats.delayPercentileNs(100)));
+    std::fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+    srand(1);
+
+    for (size_t size : bench::sizesFor(options, {1000, 100000})) {
+        bench::run(options, "prgm3/enqueue_and_dispatch", size, [size] {
+            queue<Event> eventQueue;
+            for (size_t i = 0; i < size; i++) {
+                eventQueue.push(Event(getRandomEventType(), rand() % 500, rand() % 500, getRandomTimestamp()));
+            }
+            while (!eventQueue.empty()) {
+                handleEvent(eventQueue.front());
+                eventQueue.pop();
+            }
+        });
+
+        bench::run(options, "prgm3/scheduler_enqueue_and_dispatch", size, [size] {
+            EventScheduler scheduler;
+            for (size_t i = 0; i < size; i++) {
+                scheduler.push(Event(getRandomEventType(), rand() % 500, rand() % 500, getRandomTimestamp()),
+                               eventClock::now());
+            }
+            scheduledEvent next{Event(Tap, 0, 0, ""), High, {}, {}, false};
+            while (scheduler.pop(next, eventClock::now())) {
+                handleEvent(next.event, next.degraded);
+            }
+        });
+
+        bench::run(options, "prgm3/overload_10x_simulation", size, [size] { bench::keep(simulateOverload(size).size()); });
+
+#ifdef HMI_HAS_COROUTINES
+        // `size` interactions in flight at once on one thread (virtual time)
+        bench::run(options, "prgm3/coroutine_animations_in_flight", size, [size] {
+            EventLoop loop(true);
+            for (size_t i = 0; i < size; i++) {
+                loop.spawn(animate(loop, 4));
+            }
+            loop.run();
+        });
+
+        bench::run(options, "prgm3/coroutine_await_event", size, [size] {
+            EventLoop loop(true);
+            size_t confirmed = 0;
+            for (size_t i = 0; i < size; i++) {
+                loop.spawn(confirm(loop, confirmed));
+                loop.post(Event(Tap, 0, 0, ""));
+            }
+            loop.run();
+            bench::keep(confirmed);
+        });
+#endif
+
+        // Queueing delay in simulated time under 10x overload, per class, and
+        // for high-priority events in the original FIFO loop
+        if (options.filter.empty() || string("prgm3/overload_10x_delay").find(options.filter) != string::npos) {
+            EventScheduler scheduler = simulateOverload(size);
+            reportDelays("prgm3/overload_10x_delay_high", size, scheduler.stats(High));
+            reportDelays("prgm3/overload_10x_delay_normal", size, scheduler.stats(Normal));
+            reportDelays("prgm3/overload_10x_delay_low", size, scheduler.stats(Low));
+            reportDelays("prgm3/overload_10x_delay_high_fifo", size, simulateOverloadFifo(size));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Theme switching benchmarks (Prgm4)
+#define HMI_NO_MAIN
+#include "Prgm4.cpp"
+#include "BenchHarness.h"
+
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+
+    // Base Theme objects: the Classic/Sport/Eco overrides sleep for two seconds
+    Theme classic("Red", "White", 14, "Minimal");
+    Theme sport("Red", "Black", 16, "Dynamic");
+    Theme eco("Green", "White", 15, "Flat");
+    map<string, Theme *> themes = {{"Classic", &classic}, {"Sport", &sport}, {"Eco", &eco}};
+    const string names[] = {"Classic", "Sport", "Eco"};
+
+    for (size_t size : bench::sizesFor(options, {1000, 100000})) {
+        bench::run(options, "prgm4/switchTheme", size, [&, size] {
+            for (size_t i = 0; i < size; i++) {
+                switchTheme(themes[names[i % 3]]);
+            }
+        });
+
+        // Preview formatted on every call (getters by value, as before the
+        // cache) vs the cached preview
+        bench::run(options, "prgm4/preview_formatted", size, [&, size] {
+            for (size_t i = 0; i < size; i++) {
+                Theme& theme = *themes[names[i % 3]];
+                cout << string(theme.getBackgroundColor()) << "-Background, " << string(theme.getFontColor()) << "-Font, "
+                     << theme.getFontSize() << "-px, " << string(theme.getIconStyle()) << "-Style" << '\n';
+            }
+        });
+        bench::run(options, "prgm4/preview_cached", size, [&, size] {
+            for (size_t i = 0; i < size; i++) {
+                cout << themes[names[i % 3]]->preview() << '\n';
+            }
+        });
+
+        // Per-frame label lookups, and the cost of a setter invalidating them
+        bench::run(options, "prgm4/labels_per_frame", size, [&, size] {
+            size_t total = 0;
+            for (size_t i = 0; i < size; i++) {
+                total += sport.labels().size.size();
+            }
+            bench::keep(total);
+        });
+        bench::run(options, "prgm4/setter_then_preview", size, [&, size] {
+            for (size_t i = 0; i < size; i++) {
+                eco.setFontSize(static_cast<int>(i % 40));
+                bench::keep(eco.preview());
+            }
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Control query benchmarks (Prgm5)
+#define HMI_NO_MAIN
+#include "Prgm5.cpp"
+#include "BenchHarness.h"
+
+vector<Control> makeControls(size_t size) {
+    const char* states[] = {"visible", "invisible", "disabled"};
+    vector<Control> controls;
+    controls.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        controls.push_back({static_cast<int>(i + 1), i % 2 ? "slider" : "button", states[(i * 7) % 3]});
+    }
+    return controls;
+}
+
+// Realistic layout: types in blocks of 1000, states in runs of 50-149
+vector<Control> makeControlRuns(size_t size) {
+    const char* states[] = {"visible", "invisible", "disabled"};
+    vector<Control> controls;
+    controls.reserve(size);
+    size_t run = 0, runLeft = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (runLeft == 0) {
+            run++;
+            runLeft = 50 + (run * 37) % 100;
+        }
+        runLeft--;
+        controls.push_back({static_cast<int>(i + 1), (i / 1000) % 2 ? "slider" : "button", states[run % 3]});
+    }
+    return controls;
+}
+
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+
+    for (size_t size : bench::sizesFor(options, {1000, 100000, 1000000})) {
+        vector<Control> controls = makeControls(size);
+        int searchId = static_cast<int>(size);
+
+        bench::run(options, "prgm5/find_if_id", size, [&] {
+            bench::keep(find_if(controls.begin(), controls.end(),
+                                [searchId](const Control& ctrl) { return ctrl.id == searchId; }));
+        });
+        bench::run(options, "prgm5/adjacent_find_state", size, [&] {
+            bench::keep(adjacent_find(controls.begin(), controls.end(),
+                                      [](const Control& a, const Control& b) { return a.state == b.state; }));
+        });
+        bench::run(options, "prgm5/count_if_visible", size, [&] {
+            bench::keep(count_if(controls.begin(), controls.end(),
+                                 [](const Control& ctrl) { return ctrl.state == "visible"; }));
+        });
+        bench::run(options, "prgm5/count_if_disabled_sliders", size, [&] {
+            bench::keep(count_if(controls.begin(), controls.end(), [](const Control& ctrl) {
+                return ctrl.type == "slider" && ctrl.state == "disabled";
+            }));
+        });
+        bench::run(options, "prgm5/equal_halves", size, [&] {
+            size_t half = controls.size() / 2;
+            bench::keep(equal(controls.begin(), controls.begin() + half, controls.begin() + half));
+        });
+
+        // Row store vs compressed columns on run-structured controls
+        vector<Control> runs = makeControlRuns(size);
+        ControlStore store(runs);
+        auto sameTypeState = [](const Control& a, const Control& b) { return a.type == b.type && a.state == b.state; };
+        size_t half = size / 2;
+
+        bench::run(options, "prgm5/rows_adjacent_find_state", size, [&] {
+            bench::keep(adjacent_find(runs.begin() + 1, runs.end(),
+                                      [](const Control& a, const Control& b) { return a.state == b.state; }));
+        });
+        bench::run(options, "prgm5/columns_adjacent_find_state", size, [&] { bench::keep(store.adjacentSameState()); });
+        bench::run(options, "prgm5/rows_count_disabled_sliders", size, [&] {
+            bench::keep(count_if(runs.begin(), runs.end(), [](const Control& ctrl) {
+                return ctrl.type == "slider" && ctrl.state == "disabled";
+            }));
+        });
+        bench::run(options, "prgm5/columns_count_disabled_sliders", size,
+                   [&] { bench::keep(store.countTypeState("slider", "disabled")); });
+        bench::run(options, "prgm5/rows_count_visible", size, [&] {
+            bench::keep(count_if(runs.begin(), runs.end(), [](const Control& ctrl) { return ctrl.state == "visible"; }));
+        });
+        bench::run(options, "prgm5/columns_count_visible", size, [&] { bench::keep(store.countState("visible")); });
+        bench::run(options, "prgm5/rows_equal_type_state_halves", size, [&] {
+            bench::keep(equal(runs.begin(), runs.begin() + half, runs.begin() + half, sameTypeState));
+        });
+        bench::run(options, "prgm5/columns_equal_type_state_halves", size,
+                   [&] { bench::keep(store.equalStates(0, half, half)); });
+
+        if (options.filter.empty() || string("prgm5/memory").find(options.filter) != string::npos) {
+            printf("{\"benchmark\":\"prgm5/memory\",\"size\":%zu,\"row_bytes\":%zu,\"column_bytes\":%zu}\n", size,
+                   rowMemoryBytes(runs), store.memoryBytes());
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
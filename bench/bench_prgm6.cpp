@@ -0,0 +1,76 @@
+// Widget lookup and highlighting benchmarks (Prgm6)
+#define HMI_NO_MAIN
+#include "Prgm6.cpp"
+#include "BenchHarness.h"
+
+#include <string>
+
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+
+    for (size_t size : bench::sizesFor(options, {100, 1000, 10000})) {
+        if (size < 2) {
+            continue; // needs at least one widget of each kind
+        }
+        std::vector<std::string> dynamicWidgets;
+        std::set<std::string> staticWidgets;
+        for (size_t i = 0; i < size; i++) {
+            if (i % 2) {
+                staticWidgets.insert("Static" + std::to_string(i));
+            } else {
+                dynamicWidgets.push_back("Dynamic" + std::to_string(i));
+            }
+        }
+        WidgetRegistry registry;
+        for (const auto& widget : joined(dynamicWidgets, staticWidgets)) {
+            registry.add(widget, WidgetKind::Dynamic);
+        }
+        std::vector<std::string> queries;
+        for (size_t i = 0; i < size; i++) {
+            queries.push_back((i % 2 ? "Static" : "Dynamic") + std::to_string((i * 7919) % size));
+        }
+
+        // Prgm6's original per-frame path: copy both containers, then one linear search
+        const std::string last = *staticWidgets.rbegin();
+        bench::run(options, "prgm6/copy_then_find", size, [&] {
+            std::vector<std::string> allWidgets;
+            allWidgets.insert(allWidgets.end(), dynamicWidgets.begin(), dynamicWidgets.end());
+            allWidgets.insert(allWidgets.end(), staticWidgets.begin(), staticWidgets.end());
+            bench::keep(std::find(allWidgets.begin(), allWidgets.end(), last));
+        });
+        bench::run(options, "prgm6/joined_view_find", size, [&] {
+            auto allWidgets = joined(dynamicWidgets, staticWidgets);
+            bench::keep(std::find(allWidgets.begin(), allWidgets.end(), last));
+        });
+
+        // `size` lookups each
+        bench::run(options, "prgm6/set_find", size, [&] {
+            size_t found = 0;
+            for (const auto& query : queries) {
+                found += staticWidgets.find(query) != staticWidgets.end();
+            }
+            bench::keep(found);
+        });
+        bench::run(options, "prgm6/registry_find", size, [&] {
+            size_t found = 0;
+            for (const auto& query : queries) {
+                found += registry.contains(query);
+            }
+            bench::keep(found);
+        });
+
+        // One frame with ten changed widgets: cost should not grow with size
+        HighlightEngine engine;
+        for (WidgetHandle handle = 0; handle < registry.size(); handle++) {
+            engine.setBounds(handle, {static_cast<int>(handle % 100) * 10, static_cast<int>(handle / 100) * 10, 8, 8});
+        }
+        engine.nextFrame();
+        bench::run(options, "prgm6/highlight_frame_10_changes", size, [&] {
+            for (WidgetHandle handle = 0; handle < 10; handle++) {
+                engine.setActive(handle, !engine.isActive(handle));
+            }
+            bench::keep(engine.nextFrame());
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Control transform benchmarks (Prgm7)
+#define HMI_NO_MAIN
+#include "Prgm7.cpp"
+#include "BenchHarness.h"
+
+vector<Control> makeControls(size_t size) {
+    const char* states[] = {"visible", "invisible", "disabled"};
+    vector<Control> controls;
+    controls.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        controls.push_back({static_cast<int>(i + 1), i % 2 ? "slider" : "button", states[(i * 7) % 3]});
+    }
+    return controls;
+}
+
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+
+    for (size_t size : bench::sizesFor(options, {1000, 100000, 1000000})) {
+        vector<Control> source = makeControls(size);
+        auto fresh = [&source] { return source; };
+
+        bench::run(options, "prgm7/copy_backup", size, [&] {
+            vector<Control> backup;
+            copy(source.begin(), source.end(), back_inserter(backup));
+            bench::keep(backup);
+        });
+        bench::run(options, "prgm7/transform_sliders", size, fresh, [](vector<Control>& controls) {
+            transform(controls.begin(), controls.end(), controls.begin(), [](Control& control) {
+                if (control.type == "slider") {
+                    control.state = "invisible";
+                }
+                return control;
+            });
+        });
+        bench::run(options, "prgm7/replace_disabled", size, fresh, [](vector<Control>& controls) {
+            for_each(controls.begin(), controls.end(), [](Control& control) {
+                if (control.state == "disabled") {
+                    control.state = "enabled";
+                }
+            });
+        });
+        bench::run(options, "prgm7/remove_if_invisible", size, fresh, [](vector<Control>& controls) {
+            controls.erase(remove_if(controls.begin(), controls.end(),
+                                     [](const Control& control) { return control.state == "invisible"; }),
+                           controls.end());
+        });
+        bench::run(options, "prgm7/partition_visible", size, fresh, [](vector<Control>& controls) {
+            partition(controls.begin(), controls.end(),
+                      [](const Control& control) { return control.state == "visible"; });
+        });
+    }
+    return 0;
+}
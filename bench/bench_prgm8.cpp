@@ -0,0 +1,243 @@
+// Sorting, merging and set operation benchmarks (Prgm8)
+#define HMI_NO_MAIN
+#include "Prgm8.cpp"
+#include "BenchHarness.h"
+
+#include <random>
+#include <set>
+
+vector<Control> makeControls(size_t size, unsigned seed) {
+    mt19937 gen(seed);
+    uniform_int_distribution<int> ids(0, static_cast<int>(size * 2));
+    vector<Control> controls;
+    controls.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        controls.push_back({ids(gen), i % 2 ? "slider" : "button", "visible"});
+    }
+    return controls;
+}
+
+// Controls as a program's source data holds them: literals, as in the
+// initializer lists in main()
+struct ControlSource {
+    int id;
+    const char* type;
+    const char* state;
+};
+
+vector<ControlSource> makeControlSource(size_t size) {
+    static const char* const states[] = {"visible", "invisible", "disabled"};
+    vector<ControlSource> source(size);
+    for (size_t i = 0; i < size; i++) {
+        source[i] = {static_cast<int>(i), i % 2 ? "slider" : "button", states[i / 4 % 3]};
+    }
+    return source;
+}
+
+// Dense IDs: about half of [0, 2 * size) present
+vector<int> makeIds(size_t size, unsigned seed) {
+    mt19937 gen(seed);
+    uniform_int_distribution<int> ids(0, static_cast<int>(size * 2));
+    vector<int> result(size);
+    for (auto& id : result) id = ids(gen);
+    return result;
+}
+
+// Random sets mixing sparse (array) and dense (bitmap) containers, negative
+// IDs included
+ControlIdSet makeRandomIdSet(mt19937& gen, set<int>& reference) {
+    ControlIdSet ids;
+    uniform_int_distribution<int> block(-3, 3);
+    uniform_int_distribution<int> count(0, 9000);
+    uniform_int_distribution<int> low(0, 0xFFFF);
+    for (int round = 0; round < 4; round++) {
+        int base = block(gen) * 0x10000;
+        for (int n = count(gen); n > 0; n--) {
+            int id = base + low(gen);
+            ids.insert(id);
+            reference.insert(id);
+        }
+    }
+    return ids;
+}
+
+void expectSameIds(const ControlIdSet& ids, const set<int>& reference, const char* what) {
+    vector<int> visited;
+    ids.forEach([&visited](int id) { visited.push_back(id); });
+    if (ids.cardinality() != reference.size() || !equal(visited.begin(), visited.end(), reference.begin(), reference.end())) {
+        throw runtime_error(string("ControlIdSet ") + what + " differs from std::set");
+    }
+}
+
+// Randomized equivalence of ControlIdSet and std::set, run before timing
+void checkIdSetAgainstStdSet() {
+    mt19937 gen(7);
+    for (int trial = 0; trial < 50; trial++) {
+        set<int> referenceA, referenceB, expected;
+        ControlIdSet a = makeRandomIdSet(gen, referenceA), b = makeRandomIdSet(gen, referenceB);
+        expectSameIds(a, referenceA, "insert");
+        for (int probe : {-0x30000, -1, 0, 1, 0x2FFFF}) {
+            if (a.contains(probe) != (referenceA.count(probe) != 0)) throw runtime_error("ControlIdSet contains() is wrong");
+        }
+        set_union(referenceA.begin(), referenceA.end(), referenceB.begin(), referenceB.end(), inserter(expected, expected.end()));
+        expectSameIds(ControlIdSet::unite(a, b), expected, "union");
+        expected.clear();
+        set_intersection(referenceA.begin(), referenceA.end(), referenceB.begin(), referenceB.end(),
+                         inserter(expected, expected.end()));
+        expectSameIds(ControlIdSet::intersect(a, b), expected, "intersection");
+        expected.clear();
+        set_difference(referenceA.begin(), referenceA.end(), referenceB.begin(), referenceB.end(),
+                       inserter(expected, expected.end()));
+        expectSameIds(ControlIdSet::subtract(a, b), expected, "difference");
+    }
+}
+
+// The parallel radix sort on enough controls for several blocks, against
+// std::sort on unique IDs and stable_sort on repeated ones, run before timing
+void checkParallelRadixSort() {
+    RadixWorkers workers(4);
+    size_t size = 4 * PARALLEL_RADIX_MIN_PER_THREAD + 123;
+    if (radixBlocks(size, workers) < 2) throw runtime_error("parallel radix check runs a single block");
+ 
+    vector<Control> unique(size);
+    for (size_t i = 0; i < size; i++) unique[i] = {static_cast<int>(i) - static_cast<int>(size / 2), "button", to_string(i)};
+    shuffle(unique.begin(), unique.end(), mt19937(11));
+    vector<Control> repeated = makeControls(size, 12);
+    for (size_t i = 0; i < size; i++) repeated[i].state = to_string(i);
+ 
+    auto sameOrder = [](const vector<Control>& a, const vector<Control>& b) {
+        return equal(a.begin(), a.end(), b.begin(), b.end(),
+                     [](const Control& x, const Control& y) { return x.id == y.id && x.state == y.state; });
+    };
+    vector<Control> expected = unique, sorted = unique;
+    sort(expected.begin(), expected.end(), compareById);
+    parallelRadixSortById(sorted, workers);
+    if (!sameOrder(expected, sorted)) throw runtime_error("parallel radix sort differs from std::sort");
+ 
+    expected = repeated;
+    sorted = repeated;
+    stable_sort(expected.begin(), expected.end(), compareById);
+    parallelRadixSortById(sorted, workers);
+    if (!sameOrder(expected, sorted)) throw runtime_error("parallel radix sort differs from std::stable_sort");
+}
+ 
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+    checkIdSetAgainstStdSet();
+    checkParallelRadixSort();
+    RadixWorkers radixWorkers;
+
+    for (size_t size : bench::sizesFor(options, {10000, 1000000})) {
+        vector<Control> controls1 = makeControls(size, 1);
+        vector<Control> controls2 = makeControls(size, 2);
+
+        bench::run(options, "prgm8/std_sort", size, [&] { return controls1; }, [](vector<Control>& controls) {
+            sort(controls.begin(), controls.end(), compareById);
+        });
+        bench::run(options, "prgm8/std_stable_sort", size, [&] { return controls1; }, [](vector<Control>& controls) {
+            stable_sort(controls.begin(), controls.end(), compareById);
+        });
+        bench::run(options, "prgm8/radix_sort", size, [&] { return controls1; }, [](vector<Control>& controls) {
+            radixSortById(controls);
+        });
+        bench::run(options, "prgm8/parallel_radix_sort", size, [&] { return controls1; }, [&](vector<Control>& controls) {
+            parallelRadixSortById(controls, radixWorkers);
+        });
+        bench::run(options, "prgm8/radix_sort_pairs_only", size, [&] { return makeKeyIndex(controls1); },
+                   [](vector<KeyIndex>& pairs) { radixSortPairs(pairs); });
+
+        sort(controls1.begin(), controls1.end(), compareById);
+        sort(controls2.begin(), controls2.end(), compareById);
+        bench::run(options, "prgm8/merge", size, [&] {
+            vector<Control> mergedControls;
+            merge(controls1.begin(), controls1.end(), controls2.begin(), controls2.end(),
+                  back_inserter(mergedControls), compareById);
+            bench::keep(mergedControls);
+        });
+        bench::run(options, "prgm8/lower_bound", size, [&] {
+            size_t found = 0;
+            for (size_t i = 0; i < size; i++) {
+                Control key{static_cast<int>(i * 2), "", ""};
+                found += lower_bound(controls1.begin(), controls1.end(), key, compareById) != controls1.end();
+            }
+            bench::keep(found);
+        });
+
+        string workDir = makeWorkDir("bench_prgm8_sort");
+        bench::run(options, "prgm8/external_sort", size, [&] {
+            ExternalControlSorter sorter(workDir, max(size / 8, size_t(1)));
+            for (const auto& control : controls2) sorter.add(control);
+            bench::keep(sorter.finish(workDir + "/merged.bin").size());
+        });
+        filesystem::remove_all(workDir);
+
+        // Cold start: build the control list and answer a first query (how many
+        // visible sliders). The snapshot is in the page cache after writing, so
+        // this measures mapping and use, not disk reads.
+        vector<ControlSource> source = makeControlSource(size);
+        string snapshotPath = (filesystem::temp_directory_path() / "bench_prgm8.snap").string();
+        bench::run(options, "prgm8/snapshot_write", size, [&] {
+            snapshot::Writer writer(snapshotPath);
+            for (const auto& row : source) writer.add(row);
+            writer.finish();
+        });
+        {
+            snapshot::Writer writer(snapshotPath);
+            for (const auto& row : source) writer.add(row);
+        }
+        bench::run(options, "prgm8/cold_start_rebuild", size, [&] {
+            vector<Control> controls;
+            controls.reserve(source.size());
+            for (const auto& row : source) controls.push_back({row.id, row.type, row.state});
+            size_t visibleSliders = 0;
+            for (const auto& control : controls) visibleSliders += control.type == "slider" && control.state == "visible";
+            bench::keep(visibleSliders);
+        });
+        bench::run(options, "prgm8/cold_start_snapshot", size, [&] {
+            snapshot::Snapshot mapped(snapshotPath);
+            uint16_t slider, visible;
+            size_t visibleSliders = 0;
+            if (mapped.find("slider", slider) && mapped.find("visible", visible)) {
+                for (const auto& record : mapped) visibleSliders += record.type == slider && record.state == visible;
+            }
+            bench::keep(visibleSliders);
+        });
+        bench::run(options, "prgm8/cold_start_snapshot_to_vector", size, [&] {
+            bench::keep(snapshot::Snapshot(snapshotPath).toVector<Control>());
+        });
+        filesystem::remove(snapshotPath);
+
+        // Set operations: std::set + inserter (original Step 6) vs ControlIdSet
+        vector<int> ids1 = makeIds(size, 3), ids2 = makeIds(size, 4);
+        set<int> stdSet1(ids1.begin(), ids1.end()), stdSet2(ids2.begin(), ids2.end());
+        ControlIdSet bitmap1, bitmap2;
+        for (int id : ids1) bitmap1.insert(id);
+        for (int id : ids2) bitmap2.insert(id);
+
+        bench::run(options, "prgm8/std_set_build", size, [&] { bench::keep(set<int>(ids1.begin(), ids1.end())); });
+        bench::run(options, "prgm8/bitmap_set_build", size, [&] {
+            ControlIdSet ids;
+            for (int id : ids1) ids.insert(id);
+            bench::keep(ids);
+        });
+        bench::run(options, "prgm8/std_set_union", size, [&] {
+            set<int> unionIds;
+            set_union(stdSet1.begin(), stdSet1.end(), stdSet2.begin(), stdSet2.end(), inserter(unionIds, unionIds.begin()));
+            bench::keep(unionIds);
+        });
+        bench::run(options, "prgm8/bitmap_set_union", size, [&] { bench::keep(ControlIdSet::unite(bitmap1, bitmap2)); });
+        bench::run(options, "prgm8/std_set_intersection", size, [&] {
+            set<int> intersectionIds;
+            set_intersection(stdSet1.begin(), stdSet1.end(), stdSet2.begin(), stdSet2.end(),
+                             inserter(intersectionIds, intersectionIds.begin()));
+            bench::keep(intersectionIds);
+        });
+        bench::run(options, "prgm8/bitmap_set_intersection", size, [&] {
+            bench::keep(ControlIdSet::intersect(bitmap1, bitmap2));
+        });
+        bench::run(options, "prgm8/bitmap_set_difference", size, [&] {
+            bench::keep(ControlIdSet::subtract(bitmap1, bitmap2));
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Design-pattern dispatch benchmarks (Prgm9)
+#define HMI_NO_MAIN
+#include "Prgm9.cpp"
+#include "BenchHarness.h"
+
+// Counts updates without printing, so the bus itself is measured
+class CountingObserver : public ModeObserver {
+public:
+    atomic<uint64_t> updates{0};
+    void update(HMIMode) override { updates.fetch_add(1, memory_order_relaxed); }
+};
+
+int main(int argc, char** argv) {
+    bench::Options options = bench::parseOptions(argc, argv);
+    HMISystem* hmiSystem = HMISystem::getInstance();
+
+    for (size_t size : bench::sizesFor(options, {1000, 10000, 100000})) {
+        // Singleton reads
+        bench::run(options, "prgm9/mode_snapshot", size, [&] {
+            uint64_t total = 0;
+            for (size_t i = 0; i < size; i++) {
+                total += hmiSystem->snapshot().version;
+            }
+            bench::keep(total);
+        });
+
+        // Factory
+        bench::run(options, "prgm9/make_unique_per_control", size, [size] {
+            vector<unique_ptr<Control>> controls;
+            for (size_t i = 0; i < size; i++) {
+                controls.push_back(i % 2 ? unique_ptr<Control>(make_unique<Slider>()) : make_unique<Button>());
+            }
+            bench::keep(controls);
+        });
+        bench::run(options, "prgm9/pooled_createBatch", size, [size] {
+            ControlScreen screen;
+            screen.createBatch(ButtonType, size / 2);
+            screen.createBatch(SliderType, size - size / 2);
+            bench::keep(screen.size());
+        });
+        hmimem::FrameArena arena("bench-screen", size * 64);
+        bench::run(options, "prgm9/pooled_create_frame_arena", size, [size, &arena] {
+            {
+                ControlScreen screen(&arena);
+                for (size_t i = 0; i < size; i++) {
+                    screen.create(i % 2 ? SliderType : ButtonType);
+                }
+                bench::keep(screen.size());
+            }
+            arena.reset();
+        });
+
+        // Rendering: virtual per object vs batch vs command buffer
+        ControlScreen screen;
+        vector<Control*> controls = screen.createBatch(ButtonType, size / 2);
+        vector<Control*> sliders = screen.createBatch(SliderType, size - size / 2);
+        controls.insert(controls.end(), sliders.begin(), sliders.end());
+        for (size_t i = 0; i < controls.size(); i++) {
+            controls[i]->x = static_cast<int>(i / 720 % 1920);
+            controls[i]->y = static_cast<int>(i % 720);
+        }
+        Render3D render3D;
+        RenderingStrategy* strategy = &render3D;
+        vector<float> vertices;
+        vertices.reserve(size * 3);
+
+        bench::run(options, "prgm9/render_virtual_per_control", size, [&] {
+            vertices.clear();
+            for (const Control* control : controls) {
+                strategy->project(*control, vertices);
+            }
+            bench::keep(vertices);
+        });
+        bench::run(options, "prgm9/render_batch_variant", size, [&] {
+            vertices.clear();
+            renderBatch(screen, render3D, vertices);
+            bench::keep(vertices);
+        });
+
+        HMIRenderer renderer(&render3D);
+        bench::run(options, "prgm9/command_buffer_record", size, [&] { renderer.record(screen, 4); });
+        bench::run(options, "prgm9/command_buffer_submit", size, [&] {
+            vertices.clear();
+            renderer.submit(vertices);
+            bench::keep(vertices);
+        });
+
+        // Observer bus: one mode change fanned out to `size` observers
+        vector<shared_ptr<CountingObserver>> observers;
+        for (size_t i = 0; i < size; i++) {
+            observers.push_back(make_shared<CountingObserver>());
+        }
+        HMIModeManager modeManager;
+        for (size_t i = 0; i < size; i++) {
+            modeManager.addObserver(observers[i], static_cast<int>(i % 4));
+        }
+        bool night = false;
+        bench::run(options, "prgm9/notify_and_flush", size, [&] {
+            night = !night;
+            modeManager.notifyObservers(night ? HMIMode::Night : HMIMode::Day);
+            modeManager.flush();
+        });
+        bench::run(options, "prgm9/notify_only", size, [&] {
+            night = !night;
+            modeManager.notifyObservers(night ? HMIMode::Night : HMIMode::Day);
+        });
+        modeManager.flush();
+
+        // Mode switch latency: recomputing every widget vs the per-mode cache
+        vector<ControlTypeId> widgetTypes(size);
+        for (size_t i = 0; i < size; i++) {
+            widgetTypes[i] = i % 2 ? SliderType : ButtonType;
+        }
+        vector<WidgetAppearance> recomputed(size);
+        bench::run(options, "prgm9/mode_switch_recompute_per_widget", size, [&] {
+            night = !night;
+            for (size_t i = 0; i < size; i++) {
+                recomputed[i] = computeAppearance(widgetTypes[i], night ? HMIMode::Night : HMIMode::Day);
+            }
+            bench::keep(recomputed);
+        });
+
+        auto makeCache = [&] {
+            auto cache = make_unique<ModeConfigCache>();
+            cache->addWidgets(widgetTypes);
+            cache->addListener([](const ModeTable& table) { bench::keep(table.appearances); });
+            return cache;
+        };
+        bench::run(options, "prgm9/mode_switch_cache_first_use", size, makeCache,
+                   [](unique_ptr<ModeConfigCache>& cache) { cache->switchMode(HMIMode::Night); });
+
+        unique_ptr<ModeConfigCache> cache = makeCache();
+        cache->prepare(HMIMode::Day);
+        cache->prepare(HMIMode::Night);
+        bench::run(options, "prgm9/mode_switch_cached", size, [&] {
+            night = !night;
+            bench::keep(cache->switchMode(night ? HMIMode::Night : HMIMode::Day));
+        });
+    }
+    return 0;
+}